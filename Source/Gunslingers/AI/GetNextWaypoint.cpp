@@ -2,7 +2,84 @@
 
 #include "Gunslingers.h"
 #include "GetNextWaypoint.h"
+#include "GunslingersGameState.h"
+#include "AIController.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/BlackboardData.h"
 
 
+UGetNextWaypoint::UGetNextWaypoint()
+{
+	NodeName = TEXT("Get Next Waypoint");
 
+	WaypointKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(UGetNextWaypoint, WaypointKey));
+	DestinationKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(UGetNextWaypoint, DestinationKey));
+}
 
+EBTNodeResult::Type UGetNextWaypoint::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	const AAIController* const AIController = OwnerComp.GetAIOwner();
+	const APawn* const Guard = AIController ? AIController->GetPawn() : nullptr;
+	UBlackboardComponent* const Blackboard = OwnerComp.GetBlackboardComponent();
+	const AGunslingersGameState* const GS = GetWorld()->GetGameState<AGunslingersGameState>();
+
+	if (Guard == nullptr || Blackboard == nullptr || GS == nullptr || GS->GetTileGraph().GetNumNodes() == 0)
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	/* The navmesh of a new arena is still being built, a move now would path over half of it */
+	if (!GS->IsNavigationReady())
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	const FTileGraph& TileGraph = GS->GetTileGraph();
+
+	const int32 Start = TileGraph.FindNode(GS->LocationToCell(Guard->GetActorLocation()));
+	if (Start == INDEX_NONE)
+	{
+		/* Off the arena grid, e.g. mid jump over a wall, try again once back on a tile */
+		return EBTNodeResult::Failed;
+	}
+
+	int32 Destination = INDEX_NONE;
+	const FVector DestinationLocation = Blackboard->GetValueAsVector(DestinationKey.SelectedKeyName);
+	if (FAISystem::IsValidLocation(DestinationLocation))
+	{
+		Destination = TileGraph.FindNode(GS->LocationToCell(DestinationLocation));
+	}
+
+	if (Destination == INDEX_NONE || Destination == Start)
+	{
+		Destination = FMath::RandRange(0, TileGraph.GetNumNodes() - 1);
+		Blackboard->SetValueAsVector(DestinationKey.SelectedKeyName, GS->CellToLocation(TileGraph.GetCell(Destination)));
+	}
+
+	const int32 NextHop = TileGraph.GetNextHop(Start, Destination);
+	if (NextHop == INDEX_NONE)
+	{
+		return EBTNodeResult::Failed;
+	}
+
+	Blackboard->SetValueAsVector(WaypointKey.SelectedKeyName, GS->CellToLocation(TileGraph.GetCell(NextHop)));
+
+	return EBTNodeResult::Succeeded;
+}
+
+void UGetNextWaypoint::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	UBlackboardData* const BBAsset = GetBlackboardAsset();
+	if (BBAsset)
+	{
+		WaypointKey.ResolveSelectedKey(*BBAsset);
+		DestinationKey.ResolveSelectedKey(*BBAsset);
+	}
+}
+
+FString UGetNextWaypoint::GetStaticDescription() const
+{
+	return FString::Printf(TEXT("%s: next tile toward %s into %s"), *Super::GetStaticDescription(), *DestinationKey.SelectedKeyName.ToString(), *WaypointKey.SelectedKeyName.ToString());
+}
@@ -6,14 +6,32 @@
 #include "GetNextWaypoint.generated.h"
 
 /**
- * 
+ * Picks the centre of the next tile on the guard's route through the arena tile graph.
+ * A MoveTo after this task only has to pathfind on the navmesh into the neighbouring tile,
+ * the route across the arena comes from the route cache shared by every guard.
+ * Fails until the navmesh of the current arena is built, see AGunslingersGameState::IsNavigationReady.
  */
 UCLASS()
 class GUNSLINGERS_API UGetNextWaypoint : public UBTTaskNode
 {
 	GENERATED_BODY()
-	
-	
-	
-	
+
+public:
+	UGetNextWaypoint();
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+
+	virtual FString GetStaticDescription() const override;
+
+protected:
+
+	/* Location of the next tile, written by this task */
+	UPROPERTY(EditAnywhere, Category = "Blackboard")
+	FBlackboardKeySelector WaypointKey;
+
+	/* Where the guard is heading. A random tile is picked and stored here when it is unset or reached. */
+	UPROPERTY(EditAnywhere, Category = "Blackboard")
+	FBlackboardKeySelector DestinationKey;
 };
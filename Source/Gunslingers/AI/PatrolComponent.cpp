@@ -2,6 +2,8 @@
 
 #include "Gunslingers.h"
 #include "PatrolComponent.h"
+#include "World/TickSignificanceManager.h"
+#include "World/NoiseFieldManager.h"
 
 
 // Sets default values for this component's properties
@@ -20,8 +22,17 @@ void UPatrolComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// ...
-	
+	ATickSignificanceManager* const SignificanceManager = ATickSignificanceManager::Get(this);
+	if (SignificanceManager)
+	{
+		SignificanceManager->RegisterComponent(this, false, true);
+	}
+
+	/* A random first delay spreads the guards' samples over frames */
+	if (ANoiseFieldManager::Get(this) && HearingInterval > 0.f)
+	{
+		GetWorld()->GetTimerManager().SetTimer(TimerHandle_Hearing, this, &UPatrolComponent::SampleNoiseField, HearingInterval, true, FMath::FRandRange(0.f, HearingInterval));
+	}
 }
 
 
@@ -33,3 +44,27 @@ void UPatrolComponent::TickComponent( float DeltaTime, ELevelTick TickType, FAct
 	// ...
 }
 
+
+void UPatrolComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorld()->GetTimerManager().ClearTimer(TimerHandle_Hearing);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
+void UPatrolComponent::SampleNoiseField()
+{
+	const ANoiseFieldManager* const NoiseField = ANoiseFieldManager::Get(this);
+	if (NoiseField == nullptr || GetOwner() == nullptr)
+	{
+		return;
+	}
+
+	FNoiseFieldCell Noise;
+	if (NoiseField->SampleNoise(GetOwner()->GetActorLocation(), HearingThreshold, Noise) && Noise.Time > LastHeardNoiseTime)
+	{
+		LastHeardNoiseTime = Noise.Time;
+		OnHearNoise.Broadcast(Noise.Instigator.Get(), Noise.Location, Noise.Loudness);
+	}
+}
@@ -5,6 +5,7 @@
 #include "Components/ActorComponent.h"
 #include "PatrolComponent.generated.h"
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnPatrolHearNoiseSignature, APawn*, NoiseInstigator, const FVector&, Location, float, Volume);
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class GUNSLINGERS_API UPatrolComponent : public UActorComponent
@@ -21,6 +22,26 @@ public:
 	// Called every frame
 	virtual void TickComponent( float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction ) override;
 
-		
-	
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/* Server: the owner heard a new noise in the noise field around it */
+	UPROPERTY(BlueprintAssignable, Category = "AI")
+	FOnPatrolHearNoiseSignature OnHearNoise;
+
+	/* Seconds between samples of the noise field, hearing costs the same at any rate of fire */
+	UPROPERTY(EditDefaultsOnly, Category = "AI")
+	float HearingInterval = 0.25f;
+
+	/* Noises quieter than this after decay are not heard */
+	UPROPERTY(EditDefaultsOnly, Category = "AI")
+	float HearingThreshold = 0.1f;
+
+private:
+
+	/* Look up the owner's cell and its neighbours, report the loudest noise newer than the last one heard */
+	void SampleNoiseField();
+
+	FTimerHandle TimerHandle_Hearing;
+
+	float LastHeardNoiseTime = -1.f;
 };
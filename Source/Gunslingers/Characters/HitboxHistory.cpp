@@ -0,0 +1,188 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Gunslingers.h"
+#include "HitboxHistory.h"
+#include "PhysicsEngine/PhysicsAsset.h"
+#include "PhysicsEngine/BodySetup.h"
+
+
+FHitboxHistory::FHitboxHistory()
+	: NumHitboxes(0),
+	Head(0),
+	NumSamples(0)
+{
+}
+
+void FHitboxHistory::Initialize(const ACharacter* Character)
+{
+	TArray<FHitboxShape> NewShapes;
+
+	const USkeletalMeshComponent* const Mesh = Character->GetMesh();
+	const UPhysicsAsset* const PhysicsAsset = Mesh ? Mesh->GetPhysicsAsset() : nullptr;
+
+	if (PhysicsAsset)
+	{
+		for (const USkeletalBodySetup* BodySetup : PhysicsAsset->SkeletalBodySetups)
+		{
+			const int32 BoneIndex = BodySetup ? Mesh->GetBoneIndex(BodySetup->BoneName) : INDEX_NONE;
+			if (BoneIndex == INDEX_NONE)
+			{
+				continue;
+			}
+
+			/* Capsules as they are, spheres as capsules of no length */
+			for (const FKSphylElem& Sphyl : BodySetup->AggGeom.SphylElems)
+			{
+				const FTransform ElemTM = Sphyl.GetTransform();
+				const FVector HalfAxis = ElemTM.GetUnitAxis(EAxis::Z) * Sphyl.Length * 0.5f;
+				NewShapes.Add({ BoneIndex, ElemTM.GetLocation() - HalfAxis, ElemTM.GetLocation() + HalfAxis, Sphyl.Radius });
+			}
+
+			for (const FKSphereElem& Sphere : BodySetup->AggGeom.SphereElems)
+			{
+				NewShapes.Add({ BoneIndex, Sphere.Center, Sphere.Center, Sphere.Radius });
+			}
+
+			/* Boxes and convex hulls cannot be tested as capsules, those bodies can never be hit */
+			if (BodySetup->AggGeom.SphylElems.Num() + BodySetup->AggGeom.SphereElems.Num() == 0)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("%s: body %s of %s has no capsule or sphere, it is not a hitbox."),
+					*Character->GetName(), *BodySetup->BoneName.ToString(), *PhysicsAsset->GetName());
+			}
+		}
+	}
+
+	if (NewShapes.Num() == 0)
+	{
+		float Radius = 0.f;
+		float HalfHeight = 0.f;
+		Character->GetCapsuleComponent()->GetScaledCapsuleSize(Radius, HalfHeight);
+
+		const FVector HalfAxis(0.f, 0.f, FMath::Max(0.f, HalfHeight - Radius));
+		NewShapes.Add({ INDEX_NONE, -HalfAxis, HalfAxis, Radius });
+	}
+
+	Initialize(NewShapes);
+}
+
+void FHitboxHistory::Initialize(const TArray<FHitboxShape>& NewShapes)
+{
+	Reset();
+
+	Shapes = NewShapes;
+	NumHitboxes = Shapes.Num();
+	Segments.SetNumUninitialized(MaxSamples * NumHitboxes);
+}
+
+void FHitboxHistory::Record(const ACharacter* Character, float Time)
+{
+	Record(Character->GetMesh(), Character->GetActorTransform(), Time);
+}
+
+void FHitboxHistory::Record(const USkeletalMeshComponent* Mesh, const FTransform& ActorTM, float Time)
+{
+	FHitboxSegment* const Row = Segments.GetData() + Head * NumHitboxes;
+	for (int32 i = 0; i < NumHitboxes; i++)
+	{
+		const FHitboxShape& Shape = Shapes[i];
+		const FTransform BoneTM = (Shape.BoneIndex != INDEX_NONE && Mesh) ? Mesh->GetBoneTransform(Shape.BoneIndex) : ActorTM;
+
+		Row[i].Start = BoneTM.TransformPosition(Shape.LocalStart);
+		Row[i].End = BoneTM.TransformPosition(Shape.LocalEnd);
+	}
+
+	SampleTimes[Head] = Time;
+	Head = (Head + 1) % MaxSamples;
+	NumSamples = FMath::Min(NumSamples + 1, MaxSamples);
+}
+
+float FHitboxHistory::ClampRewindTime(float ShotTime, float Now, float MaxRewindSeconds)
+{
+	return FMath::Clamp(ShotTime, Now - FMath::Max(0.f, MaxRewindSeconds), Now);
+}
+
+void FHitboxHistory::Reset()
+{
+	Head = 0;
+	NumSamples = 0;
+}
+
+bool FHitboxHistory::SegmentHits(const FVector& Start, const FVector& End, float Time, float Tolerance, FVector* OutShotPoint) const
+{
+	if (NumSamples == 0)
+	{
+		return false;
+	}
+
+	/* Newest sample at or before Time, clamped to the recorded range */
+	int32 Older = 0;
+	while (Older + 1 < NumSamples && SampleTimes[GetSampleIndex(Older + 1)] <= Time)
+	{
+		Older++;
+	}
+	const int32 Newer = FMath::Min(Older + 1, NumSamples - 1);
+
+	const int32 OlderIndex = GetSampleIndex(Older);
+	const int32 NewerIndex = GetSampleIndex(Newer);
+	const float Span = SampleTimes[NewerIndex] - SampleTimes[OlderIndex];
+	const float Alpha = Span > KINDA_SMALL_NUMBER ? FMath::Clamp((Time - SampleTimes[OlderIndex]) / Span, 0.f, 1.f) : 0.f;
+
+	bool bHit = false;
+	float NearestDistSquared = MAX_flt;
+
+	const FHitboxSegment* const OlderRow = GetRow(OlderIndex);
+	const FHitboxSegment* const NewerRow = GetRow(NewerIndex);
+
+	for (int32 i = 0; i < NumHitboxes; i++)
+	{
+		const FHitboxSegment& A = OlderRow[i];
+		const FHitboxSegment& B = NewerRow[i];
+
+		FVector OnShot;
+		FVector OnHitbox;
+		FMath::SegmentDistToSegmentSafe(Start, End, FMath::Lerp(A.Start, B.Start, Alpha), FMath::Lerp(A.End, B.End, Alpha), OnShot, OnHitbox);
+
+		if (FVector::DistSquared(OnShot, OnHitbox) <= FMath::Square(Shapes[i].Radius + Tolerance))
+		{
+			if (OutShotPoint == nullptr)
+			{
+				return true;
+			}
+
+			const float DistSquared = FVector::DistSquared(Start, OnShot);
+			if (DistSquared < NearestDistSquared)
+			{
+				NearestDistSquared = DistSquared;
+				*OutShotPoint = OnShot;
+			}
+			bHit = true;
+		}
+	}
+
+	return bHit;
+}
+
+int32 FHitboxHistory::GetNumSamples() const
+{
+	return NumSamples;
+}
+
+int32 FHitboxHistory::GetNumHitboxes() const
+{
+	return NumHitboxes;
+}
+
+float FHitboxHistory::GetOldestTime() const
+{
+	return NumSamples > 0 ? SampleTimes[GetSampleIndex(0)] : 0.f;
+}
+
+float FHitboxHistory::GetNewestTime() const
+{
+	return NumSamples > 0 ? SampleTimes[GetSampleIndex(NumSamples - 1)] : 0.f;
+}
+
+int32 FHitboxHistory::GetSampleIndex(int32 I) const
+{
+	return (Head - NumSamples + I + MaxSamples) % MaxSamples;
+}
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+/* One capsule of a character's hitbox set, in the space of the bone it follows */
+struct FHitboxShape
+{
+	/* INDEX_NONE for the actor transform */
+	int32 BoneIndex;
+	FVector LocalStart;
+	FVector LocalEnd;
+	float Radius;
+};
+
+/* Capsule segment of one hitbox in world space at one sample */
+struct FHitboxSegment
+{
+	FVector Start;
+	FVector End;
+};
+
+/**
+* Fixed size ring buffer of a character's hitbox capsules in world space, recorded by the server
+* every frame. Shots are checked against the pose interpolated at the shooter's time with plain
+* segment to capsule tests, the physics scene is never moved back.
+*
+* Samples are stored contiguously, one row of segments per sample, so a rewind reads two rows.
+* The buffer is sized once from the physics asset, every body is a hitbox, and is not resized while
+* recording: 24 bytes per hitbox and sample, under 15 KB for a 19 body mannequin.
+*/
+class GUNSLINGERS_API FHitboxHistory
+{
+public:
+	FHitboxHistory();
+
+	/* Samples kept, one per server frame: about a second at 30 Hz */
+	static const int32 MaxSamples = 32;
+
+	/* Capsules from the physics asset of the character mesh, the collision capsule when it has none */
+	void Initialize(const class ACharacter* Character);
+
+	/* Start over with these capsules */
+	void Initialize(const TArray<FHitboxShape>& NewShapes);
+
+	void Record(const class ACharacter* Character, float Time);
+
+	/* Record the shapes on the bones of Mesh, and on ActorTM for the ones without a bone or without a mesh */
+	void Record(const class USkeletalMeshComponent* Mesh, const FTransform& ActorTM, float Time);
+
+	/* Time a shot at ShotTime is checked at: never in the future, never further back than MaxRewindSeconds */
+	static float ClampRewindTime(float ShotTime, float Now, float MaxRewindSeconds);
+
+	void Reset();
+
+	/* Does the segment pass within Tolerance of a hitbox of the pose at Time. Times outside
+	   the history use the oldest or newest sample. OutShotPoint, when given, gets the point of
+	   the segment closest to the nearest hitbox it hits. */
+	bool SegmentHits(const FVector& Start, const FVector& End, float Time, float Tolerance, FVector* OutShotPoint = nullptr) const;
+
+	int32 GetNumSamples() const;
+
+	int32 GetNumHitboxes() const;
+
+	float GetOldestTime() const;
+
+	float GetNewestTime() const;
+
+private:
+
+	/* Sample index of the I-th oldest sample */
+	int32 GetSampleIndex(int32 I) const;
+
+	/* First segment of a sample's row */
+	FORCEINLINE const FHitboxSegment* GetRow(int32 SampleIndex) const
+	{
+		return Segments.GetData() + SampleIndex * NumHitboxes;
+	}
+
+	TArray<FHitboxShape> Shapes;
+
+	int32 NumHitboxes;
+
+	float SampleTimes[MaxSamples];
+
+	/* MaxSamples rows of NumHitboxes segments */
+	TArray<FHitboxSegment> Segments;
+
+	/* Where the next sample is written */
+	int32 Head;
+
+	int32 NumSamples;
+};
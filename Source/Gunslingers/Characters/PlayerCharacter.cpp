@@ -4,6 +4,8 @@
 #include "GameFramework/InputSettings.h"
 #include "World/UsableActor.h"
 #include "Items/Weapons/Weapon.h"
+#include "World/TickSignificanceManager.h"
+#include "World/NoiseFieldManager.h"
 #include "Runtime/Engine/Classes/Animation/AnimInstance.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogFPChar, Warning, All);
@@ -78,6 +80,28 @@ void APlayerCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 
+	/* Sprinting is applied from Tick, so far pawns are only slowed down, never switched off */
+	ATickSignificanceManager* const SignificanceManager = ATickSignificanceManager::Get(this);
+	if (SignificanceManager)
+	{
+		SignificanceManager->RegisterActor(this, true, false);
+	}
+
+	if (Role == ROLE_Authority)
+	{
+		HitboxHistory.Initialize(this);
+
+		/* A dedicated server does not render the mesh, without this its bones never move. The
+		   history is recorded after physics, once the mesh has ticked its pose for this frame. */
+		GetMesh()->MeshComponentUpdateFlag = EMeshComponentUpdateFlag::AlwaysTickPoseAndRefreshBones;
+
+		HitboxRecordTick.Target = this;
+		HitboxRecordTick.TickGroup = TG_PostPhysics;
+		HitboxRecordTick.bCanEverTick = true;
+		HitboxRecordTick.RegisterTickFunction(GetLevel());
+		HitboxRecordTick.AddPrerequisite(GetMesh(), GetMesh()->PrimaryComponentTick);
+	}
+
 	if (WeaponBlueprint == NULL) {
 		UE_LOG(LogTemp, Warning, TEXT("Weapon blueprint missing."));
 		return;
@@ -89,6 +113,16 @@ void APlayerCharacter::BeginPlay()
 	Weapon->AttachToComponent(GetMesh(), FAttachmentTransformRules(EAttachmentRule::SnapToTarget, true), EquippedAttachPoint);
 }
 
+void APlayerCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (HitboxRecordTick.IsTickFunctionRegistered())
+	{
+		HitboxRecordTick.UnRegisterTickFunction();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void APlayerCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
@@ -724,8 +758,16 @@ void APlayerCharacter::MakePawnNoise(float Loudness)
 {
 	if (Role == ROLE_Authority)
 	{
-		/* Make noise to be picked up by PawnSensingComponent by the enemy pawns */
-		MakeNoise(Loudness, this, GetActorLocation());
+		/* Guards sample the noise field when there is one, otherwise PawnSensingComponent of the enemy pawns picks it up */
+		ANoiseFieldManager* const NoiseField = ANoiseFieldManager::Get(this);
+		if (NoiseField)
+		{
+			NoiseField->ReportNoise(this, GetActorLocation(), Loudness);
+		}
+		else
+		{
+			MakeNoise(Loudness, this, GetActorLocation());
+		}
 	}
 
 	LastNoiseLoudness = Loudness;
@@ -744,6 +786,64 @@ float APlayerCharacter::GetLastMakeNoiseTime()
 	return LastMakeNoiseTime;
 }
 
+const FHitboxHistory& APlayerCharacter::GetHitboxHistory() const
+{
+	return HitboxHistory;
+}
+
+void APlayerCharacter::RecordHitboxes()
+{
+	if (!bIsDying)
+	{
+		HitboxHistory.Record(this, GetWorld()->GetTimeSeconds());
+	}
+}
+
+void FHitboxRecordTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target && !Target->IsPendingKill() && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Target->RecordHitboxes();
+	}
+}
+
+FString FHitboxRecordTickFunction::DiagnosticMessage()
+{
+	return Target ? Target->GetFullName() + TEXT("[RecordHitboxes]") : TEXT("<null>[RecordHitboxes]");
+}
+
+void APlayerCharacter::ResetForNewRound()
+{
+	if (Role < ROLE_Authority || bIsDying)
+	{
+		return;
+	}
+
+	Health = GetClass()->GetDefaultObject<APlayerCharacter>()->Health;
+
+	StopAllAnimMontages();
+	bWantsToFire = false;
+
+	/* The pawn is about to be teleported, old poses must not be rewound into */
+	HitboxHistory.Reset();
+
+	/* Refill the weapons instead of spawning new ones */
+	if (Weapon && !Inventory.Contains(Weapon))
+	{
+		Weapon->StopFire();
+		Weapon->SetAmmoCount(Weapon->GetStartAmmo());
+	}
+
+	for (AWeapon* InventoryWeapon : Inventory)
+	{
+		if (InventoryWeapon)
+		{
+			InventoryWeapon->StopFire();
+			InventoryWeapon->SetAmmoCount(InventoryWeapon->GetStartAmmo());
+		}
+	}
+}
+
 /************************************************************************/
 /* Section 5: Inventory	                                                */
 /************************************************************************/
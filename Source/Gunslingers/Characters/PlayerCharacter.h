@@ -1,5 +1,6 @@
 #pragma once
 #include "GameFramework/Character.h"
+#include "HitboxHistory.h"
 #include "PlayerCharacter.generated.h"
 
 /************************************************************************/
@@ -136,6 +137,36 @@ public:
 	}
 };
 
+/**
+* Server tick recording the character's hitboxes once its mesh has been animated this frame
+*/
+
+USTRUCT()
+struct FHitboxRecordTickFunction : public FTickFunction
+{
+	GENERATED_USTRUCT_BODY()
+
+	class APlayerCharacter* Target;
+
+	FHitboxRecordTickFunction()
+		: Target(nullptr)
+	{
+	}
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FHitboxRecordTickFunction> : public TStructOpsTypeTraitsBase
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
 /**
 * Player constructor begins here
 */
@@ -153,6 +184,8 @@ public:
 
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	virtual void Tick(float DeltaSeconds) override;
 
 	void StopAllAnimMontages();
@@ -338,8 +371,21 @@ public:
 	float LastNoiseLoudness;
 	float LastMakeNoiseTime;
 
+	/* Server only: restore health and ammo so the pawn can be reused for the next round */
+	void ResetForNewRound();
+
+	/* Server only: recent hitbox poses, for checking client hits against what the shooter saw */
+	const FHitboxHistory& GetHitboxHistory() const;
+
+	/* Server only: add this frame's hitbox poses, called by HitboxRecordTick after the mesh ticked */
+	void RecordHitboxes();
+
 private:
 
+	FHitboxHistory HitboxHistory;
+
+	FHitboxRecordTickFunction HitboxRecordTick;
+
 	UPROPERTY(EditDefaultsOnly, Category = "Status", Replicated)
 		float Health;
 
@@ -0,0 +1,275 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Gunslingers.h"
+#include "LevelGenBenchmarkCommandlet.h"
+#include "World/LevelLayoutGenerator.h"
+#include "World/LevelLayoutCache.h"
+#include "World/TileGraph.h"
+
+
+static bool LayoutsMatch(const FLevelLayout& A, const FLevelLayout& B)
+{
+	if (A.TileCells != B.TileCells || A.TileRotations != B.TileRotations || A.WallCells != B.WallCells ||
+		A.WallRuns.Num() != B.WallRuns.Num() || A.AllocatedCells.Num() != B.AllocatedCells.Num() || A.Checksum != B.Checksum)
+	{
+		return false;
+	}
+
+	for (int32 i = 0; i < A.WallRuns.Num(); i++)
+	{
+		if (A.WallRuns[i].Start != B.WallRuns[i].Start || A.WallRuns[i].Length != B.WallRuns[i].Length || A.WallRuns[i].bAlongX != B.WallRuns[i].bAlongX)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Navmesh tiles under the box of cells from CellMin to CellMax, grown by Margin as the game state grows its dirty areas */
+static void AddNavTiles(const FIntPoint& CellMin, const FIntPoint& CellMax, float TileOffset, float Margin, float NavTileSize, TSet<FIntPoint>& OutNavTiles)
+{
+	const float Extent = TileOffset * 0.5f + Margin;
+	const int32 MinX = FMath::FloorToInt((CellMin.X * TileOffset - Extent) / NavTileSize);
+	const int32 MinY = FMath::FloorToInt((CellMin.Y * TileOffset - Extent) / NavTileSize);
+	const int32 MaxX = FMath::CeilToInt((CellMax.X * TileOffset + Extent) / NavTileSize) - 1;
+	const int32 MaxY = FMath::CeilToInt((CellMax.Y * TileOffset + Extent) / NavTileSize) - 1;
+
+	for (int32 Y = MinY; Y <= MaxY; Y++)
+	{
+		for (int32 X = MinX; X <= MaxX; X++)
+		{
+			OutNavTiles.Add(FIntPoint(X, Y));
+		}
+	}
+}
+
+/* Navmesh tile builds for spawning a layout with navigation updating as it goes, and with it deferred to the end */
+struct FNavBuildCounts
+{
+	int32 IncrementalBuilds;
+	int32 IncrementalAfterReady;
+	int32 DeferredBuilds;
+};
+
+static FNavBuildCounts CountNavBuilds(const FLevelLayout& Layout, float TileOffset, float NavTileSize, int32 SpawnsPerFrame)
+{
+	/* Cells covered by each spawn, in the order of QueueLayoutSpawns: floors, then one wall per run */
+	TArray<FIntPoint> SpawnMins;
+	TArray<FIntPoint> SpawnMaxs;
+	for (const FIntPoint& Cell : Layout.TileCells)
+	{
+		SpawnMins.Add(Cell);
+		SpawnMaxs.Add(Cell);
+	}
+	for (const FWallRun& Run : Layout.WallRuns)
+	{
+		const FIntPoint End = Run.Start + (Run.bAlongX ? FIntPoint(Run.Length - 1, 0) : FIntPoint(0, Run.Length - 1));
+		SpawnMins.Add(Run.Start.ComponentMin(End));
+		SpawnMaxs.Add(Run.Start.ComponentMax(End));
+	}
+
+	FNavBuildCounts Counts = { 0, 0, 0 };
+	if (SpawnMins.Num() == 0)
+	{
+		return Counts;
+	}
+
+	/* The dynamic navmesh rebuilds each frame's dirty tiles once, the last frame's after the arena is ready */
+	TSet<FIntPoint> FrameTiles;
+	FIntPoint ArenaMin = SpawnMins[0];
+	FIntPoint ArenaMax = SpawnMaxs[0];
+
+	for (int32 i = 0; i < SpawnMins.Num(); i++)
+	{
+		AddNavTiles(SpawnMins[i], SpawnMaxs[i], TileOffset, 0.f, NavTileSize, FrameTiles);
+		ArenaMin = ArenaMin.ComponentMin(SpawnMins[i]);
+		ArenaMax = ArenaMax.ComponentMax(SpawnMaxs[i]);
+
+		if ((i + 1) % SpawnsPerFrame == 0 || i == SpawnMins.Num() - 1)
+		{
+			Counts.IncrementalBuilds += FrameTiles.Num();
+			Counts.IncrementalAfterReady = FrameTiles.Num();
+			FrameTiles.Reset();
+		}
+	}
+
+	/* One dirty area over the arena bounds grown by half a tile, all of it built after the last spawn */
+	TSet<FIntPoint> ArenaTiles;
+	AddNavTiles(ArenaMin, ArenaMax, TileOffset, TileOffset * 0.5f, NavTileSize, ArenaTiles);
+	Counts.DeferredBuilds = ArenaTiles.Num();
+
+	return Counts;
+}
+
+ULevelGenBenchmarkCommandlet::ULevelGenBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 ULevelGenBenchmarkCommandlet::Main(const FString& Params)
+{
+	/* Player counts to sweep, tiles are 3 per player as in the game mode */
+	FString PlayersParam = TEXT("8,16,32,64,128,256,512,1024,4096");
+	FParse::Value(*Params, TEXT("players="), PlayersParam);
+
+	int32 NumSeeds = 10;
+	FParse::Value(*Params, TEXT("seeds="), NumSeeds);
+
+	int32 FirstSeed = 1;
+	FParse::Value(*Params, TEXT("firstseed="), FirstSeed);
+
+	FString CsvPath;
+	FParse::Value(*Params, TEXT("csv="), CsvPath);
+
+	const bool bRoundTrip = FParse::Param(*Params, TEXT("roundtrip"));
+
+	/* Route queries per layout, spread over a few shared destinations like a squad of guards */
+	int32 NumPathQueries = 0;
+	FParse::Value(*Params, TEXT("paths="), NumPathQueries);
+
+	int32 NumPathDestinations = 8;
+	FParse::Value(*Params, TEXT("destinations="), NumPathDestinations);
+
+	/* Navmesh rebuild model, the defaults are the game mode's tile size and about the recast navmesh's tile size */
+	const bool bNavMesh = FParse::Param(*Params, TEXT("navmesh"));
+
+	float TileOffset = 4000.f;
+	FParse::Value(*Params, TEXT("tileoffset="), TileOffset);
+
+	float NavTileSize = 1000.f;
+	FParse::Value(*Params, TEXT("navtilesize="), NavTileSize);
+
+	int32 SpawnsPerFrame = 8;
+	FParse::Value(*Params, TEXT("spawnsperframe="), SpawnsPerFrame);
+	SpawnsPerFrame = FMath::Max(1, SpawnsPerFrame);
+
+	int32 NumCheckFailures = 0;
+
+	TArray<FString> PlayerTokens;
+	PlayersParam.ParseIntoArray(PlayerTokens, TEXT(","), true);
+
+	FString Csv = TEXT("Players,Seed,Tiles,WallCells,WallRuns,Milliseconds,LayoutBytes,MaxWalkRetries,Checksum,FileBytes,RoundTrip,PathQueries,SearchMs,CachedMs,")
+		TEXT("NavIncrementalBuilds,NavIncrementalAfterReady,NavDeferredBuilds\n");
+
+	for (const FString& PlayerToken : PlayerTokens)
+	{
+		const int32 NumberOfPlayers = FCString::Atoi(*PlayerToken);
+		if (NumberOfPlayers <= 0)
+		{
+			continue;
+		}
+
+		for (int32 Seed = FirstSeed; Seed < FirstSeed + NumSeeds; Seed++)
+		{
+			FLevelLayout Layout;
+
+			const double StartTime = FPlatformTime::Seconds();
+
+			FLevelLayoutGenerator Generator(Seed, 3 * NumberOfPlayers);
+			Generator.Generate(Layout);
+
+			const double Milliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+			int32 FileBytes = 0;
+			const TCHAR* RoundTripResult = TEXT("");
+
+			if (bRoundTrip)
+			{
+				TArray<uint8> Data;
+				FLevelLayoutCache::Serialize(Layout, Seed, 3 * NumberOfPlayers, Data);
+				FileBytes = Data.Num();
+
+				FLevelLayout Loaded;
+				const bool bMatches = FLevelLayoutCache::Deserialize(Data, Seed, 3 * NumberOfPlayers, Loaded) && LayoutsMatch(Layout, Loaded);
+
+				RoundTripResult = bMatches ? TEXT("OK") : TEXT("FAIL");
+				if (!bMatches)
+				{
+					NumCheckFailures++;
+				}
+			}
+
+			double SearchMs = 0.0;
+			double CachedMs = 0.0;
+
+			if (NumPathQueries > 0)
+			{
+				FTileGraph TileGraph;
+				TileGraph.Build(Layout);
+
+				/* Same queries both ways: a full search per query against walking the cached next hops */
+				FRandomStream QueryStream(Seed);
+				TArray<int32> Destinations;
+				for (int32 i = 0; i < FMath::Max(1, NumPathDestinations); i++)
+				{
+					Destinations.Add(QueryStream.RandRange(0, TileGraph.GetNumNodes() - 1));
+				}
+
+				TArray<int32> Starts;
+				for (int32 i = 0; i < NumPathQueries; i++)
+				{
+					Starts.Add(QueryStream.RandRange(0, TileGraph.GetNumNodes() - 1));
+				}
+
+				int32 SearchSteps = 0;
+				TArray<int32> Route;
+				const double SearchStart = FPlatformTime::Seconds();
+				for (int32 i = 0; i < NumPathQueries; i++)
+				{
+					TileGraph.FindRouteUncached(Starts[i], Destinations[i % Destinations.Num()], Route);
+					SearchSteps += Route.Num() - 1;
+				}
+				SearchMs = (FPlatformTime::Seconds() - SearchStart) * 1000.0;
+
+				int32 CachedSteps = 0;
+				const double CachedStart = FPlatformTime::Seconds();
+				for (int32 i = 0; i < NumPathQueries; i++)
+				{
+					const int32 Destination = Destinations[i % Destinations.Num()];
+					for (int32 Node = Starts[i]; Node != Destination && Node != INDEX_NONE; Node = TileGraph.GetNextHop(Node, Destination))
+					{
+						CachedSteps++;
+					}
+				}
+				CachedMs = (FPlatformTime::Seconds() - CachedStart) * 1000.0;
+
+				if (SearchSteps != CachedSteps)
+				{
+					UE_LOG(LogTemp, Error, TEXT("Seed %d: cached routes take %d steps, searched routes %d."), Seed, CachedSteps, SearchSteps);
+					NumCheckFailures++;
+				}
+			}
+
+			FNavBuildCounts NavCounts = { 0, 0, 0 };
+			if (bNavMesh)
+			{
+				NavCounts = CountNavBuilds(Layout, TileOffset, NavTileSize, SpawnsPerFrame);
+			}
+
+			const FString Row = FString::Printf(TEXT("%d,%d,%d,%d,%d,%.3f,%llu,%d,%08x,%d,%s,%d,%.3f,%.3f,%d,%d,%d"),
+				NumberOfPlayers, Seed, Layout.TileCells.Num(), Layout.WallCells.Num(), Layout.WallRuns.Num(), Milliseconds, (uint64)Layout.GetAllocatedSize(), Layout.MaxWalkRetries, Layout.Checksum, FileBytes, RoundTripResult,
+				NumPathQueries, SearchMs, CachedMs, NavCounts.IncrementalBuilds, NavCounts.IncrementalAfterReady, NavCounts.DeferredBuilds);
+
+			UE_LOG(LogTemp, Display, TEXT("%s"), *Row);
+			Csv += Row + TEXT("\n");
+		}
+	}
+
+	if (!CsvPath.IsEmpty() && !FFileHelper::SaveStringToFile(Csv, *CsvPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Could not write %s."), *CsvPath);
+		return 1;
+	}
+
+	if (NumCheckFailures > 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%d layouts failed the round trip or route checks."), NumCheckFailures);
+		return 1;
+	}
+
+	return 0;
+}
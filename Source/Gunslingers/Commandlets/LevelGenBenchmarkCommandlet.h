@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "LevelGenBenchmarkCommandlet.generated.h"
+
+/**
+* Runs the arena layout generator headless over a sweep of player counts and seeds and writes a CSV report.
+*
+* UE4Editor-Cmd Gunslingers.uproject -run=LevelGenBenchmark -nullrhi -players=8,64,512 -seeds=10 -csv=Saved/LevelGen.csv
+*
+* -roundtrip also writes every layout to the binary cache format, reads it back and compares the result.
+*
+* -paths=N times N tile graph route queries per layout over -destinations= shared targets (default 8),
+* once as a fresh search per query and once through the shared route cache.
+*
+* -navmesh counts the navmesh tiles of -navtilesize= (default 1000) the arena dirties at -tileoffset= (default 4000),
+* spawned -spawnsperframe= (default 8) actors a frame: rebuilt incrementally under every frame's spawns against
+* built once over the whole arena as bDeferNavigationBuild does, in total and after the last spawn.
+*/
+UCLASS()
+class ULevelGenBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	ULevelGenBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,535 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Gunslingers.h"
+#include "WeaponBenchmarkCommandlet.h"
+#include "Items/Weapons/WeaponStateMachine.h"
+#include "Items/Weapons/WeaponFireScheduler.h"
+#include "Characters/HitboxHistory.h"
+#include "GunslingersProjectile.h"
+#include "GunslingersProjectilePool.h"
+
+typedef FWeaponStateMachine::EState EWeaponMachineState;
+
+
+/* What DetermineState must return, written out from the firing rules instead of the machine's own code */
+static EWeaponMachineState ExpectedState(EWeaponMachineState Current, const FWeaponStateInputs& Inputs)
+{
+	if (!Inputs.bEquipped)
+	{
+		return Inputs.bPendingEquip ? EWeaponMachineState::Equipping : EWeaponMachineState::Idle;
+	}
+
+	const bool bCanAct = Current == EWeaponMachineState::Idle || Current == EWeaponMachineState::Firing;
+
+	if (Inputs.bPendingReload)
+	{
+		const bool bRoomInClip = Inputs.AmmoInClip < Inputs.MaxAmmoPerClip;
+		const bool bAmmoLeft = Inputs.Ammo > Inputs.AmmoInClip;
+		return (bCanAct && Inputs.bPawnCanReload && bRoomInClip && bAmmoLeft) ? EWeaponMachineState::Reloading : Current;
+	}
+
+	return (bCanAct && Inputs.bWantsToFire && Inputs.bPawnCanFire) ? EWeaponMachineState::Firing : EWeaponMachineState::Idle;
+}
+
+/* Count of the combinations that break a rule, each one is logged */
+static int32 CheckStateMachine(int32& OutNumCases)
+{
+	static const int32 MaxAmmoPerClip = 30;
+	static const int32 AmmoCases[][2] = { { 0, 0 }, { 5, 0 }, { 5, 5 }, { 40, 0 }, { 40, 12 }, { 40, 30 }, { 999, 30 } };
+
+	int32 NumFailures = 0;
+	OutNumCases = 0;
+
+	for (uint8 State = 0; State < (uint8)EWeaponMachineState::Count; State++)
+	{
+		const EWeaponMachineState Current = (EWeaponMachineState)State;
+
+		for (int32 Flags = 0; Flags < (1 << 6); Flags++)
+		{
+			for (const int32* Ammo : AmmoCases)
+			{
+				FWeaponStateInputs Inputs;
+				Inputs.bEquipped = (Flags & 1) != 0;
+				Inputs.bPendingEquip = (Flags & 2) != 0;
+				Inputs.bWantsToFire = (Flags & 4) != 0;
+				Inputs.bPendingReload = (Flags & 8) != 0;
+				Inputs.bPawnCanFire = (Flags & 16) != 0;
+				Inputs.bPawnCanReload = (Flags & 32) != 0;
+				Inputs.Ammo = Ammo[0];
+				Inputs.AmmoInClip = Ammo[1];
+				Inputs.MaxAmmoPerClip = MaxAmmoPerClip;
+				OutNumCases++;
+
+				const EWeaponMachineState Next = FWeaponStateMachine::DetermineState(Current, Inputs);
+				if (Next != ExpectedState(Current, Inputs))
+				{
+					UE_LOG(LogTemp, Error, TEXT("State %d, inputs %02x, ammo %d/%d: chose state %d, expected %d."),
+						State, Flags, Inputs.AmmoInClip, Inputs.Ammo, (uint8)Next, (uint8)ExpectedState(Current, Inputs));
+					NumFailures++;
+				}
+
+				/* A finished reload never overfills the clip or takes more than is left */
+				const int32 Reloaded = FWeaponStateMachine::GetReloadAmount(Inputs.Ammo, Inputs.AmmoInClip, Inputs.MaxAmmoPerClip);
+				if (Reloaded < 0 || Inputs.AmmoInClip + Reloaded > Inputs.MaxAmmoPerClip || Inputs.AmmoInClip + Reloaded > Inputs.Ammo)
+				{
+					UE_LOG(LogTemp, Error, TEXT("Ammo %d/%d: reload adds %d rounds."), Inputs.AmmoInClip, Inputs.Ammo, Reloaded);
+					NumFailures++;
+				}
+			}
+		}
+	}
+
+	/* The burst starts on entering Firing and finishes on leaving it, nothing else has effects */
+	for (uint8 From = 0; From < (uint8)EWeaponMachineState::Count; From++)
+	{
+		for (uint8 To = 0; To < (uint8)EWeaponMachineState::Count; To++)
+		{
+			const bool bFromFiring = From == (uint8)EWeaponMachineState::Firing;
+			const bool bToFiring = To == (uint8)EWeaponMachineState::Firing;
+			const uint8 Expected = (!bFromFiring && bToFiring ? FWeaponStateMachine::BurstStarted : 0) | (bFromFiring && !bToFiring ? FWeaponStateMachine::BurstFinished : 0);
+			const uint8 Effects = FWeaponStateMachine::GetTransitionEffects((EWeaponMachineState)From, (EWeaponMachineState)To);
+			OutNumCases++;
+
+			if (Effects != Expected)
+			{
+				UE_LOG(LogTemp, Error, TEXT("Transition %d -> %d has effects %02x, expected %02x."), From, To, Effects, Expected);
+				NumFailures++;
+			}
+		}
+	}
+
+	return NumFailures;
+}
+
+/* Server frame rate and speed of the characters the rewind case records */
+static const float RewindSampleRate = 30.f;
+static const float RewindCharacterSpeed = 600.f;
+
+/* Where the rewind case's character Index stands at Time, on a ring around the shooter at the origin, strafing */
+static FVector GetRewindCharacterLocation(int32 Index, int32 NumCharacters, float Time)
+{
+	const float Angle = 2.f * PI * Index / NumCharacters;
+	const FVector Direction(FMath::Cos(Angle), FMath::Sin(Angle), 0.f);
+	const FVector Strafe(-Direction.Y, Direction.X, 0.f);
+
+	return Direction * 1000.f + Strafe * RewindCharacterSpeed * Time;
+}
+
+/* Count of rewinds that hit where they should miss or the other way around, and of rewind times clamped wrong */
+static int32 CheckRewind(const TArray<FHitboxHistory>& Histories, float Tolerance, int32& OutNumCases)
+{
+	int32 NumFailures = 0;
+	OutNumCases = 0;
+
+	/* Between two samples, so the pose is interpolated */
+	const float ShotTime = (FHitboxHistory::MaxSamples / 2 + 0.5f) / RewindSampleRate;
+
+	for (int32 i = 0; i < Histories.Num(); i++)
+	{
+		const FVector Target = GetRewindCharacterLocation(i, Histories.Num(), ShotTime);
+
+		/* Aimed at where the character was at ShotTime: a hit then, a miss half a second later when it strafed 300 units away */
+		const bool bHitThen = Histories[i].SegmentHits(FVector::ZeroVector, Target * 2.f, ShotTime, Tolerance);
+		const bool bHitLater = Histories[i].SegmentHits(FVector::ZeroVector, Target * 2.f, ShotTime + 0.5f, Tolerance);
+		OutNumCases += 2;
+
+		if (!bHitThen || bHitLater)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Character %d: shot at %.3f s hit %d, half a second later hit %d."), i, ShotTime, bHitThen, bHitLater);
+			NumFailures++;
+		}
+	}
+
+	/* Rewinds never go past the limit and never into the future, anything in between is kept */
+	static const float RewindCases[][3] = { { -1.f, 0.2f, -0.2f }, { 1.f, 0.2f, 0.f }, { -0.1f, 0.2f, -0.1f }, { -0.1f, 0.f, 0.f }, { -0.1f, -1.f, 0.f } };
+	const float Now = 100.f;
+
+	for (const float* Case : RewindCases)
+	{
+		const float RewindTime = FHitboxHistory::ClampRewindTime(Now + Case[0], Now, Case[1]);
+		OutNumCases++;
+
+		if (!FMath::IsNearlyEqual(RewindTime, Now + Case[2], KINDA_SMALL_NUMBER))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Shot %.2f s ago with a %.2f s limit rewinds to %.3f s, expected %.3f s."), -Case[0], Case[1], RewindTime - Now, Case[2]);
+			NumFailures++;
+		}
+	}
+
+	return NumFailures;
+}
+
+UWeaponBenchmarkCommandlet::UWeaponBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UWeaponBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString CsvPath;
+	FParse::Value(*Params, TEXT("csv="), CsvPath);
+
+	int32 NumCheckFailures = 0;
+	FString Csv = TEXT("Test,Case,Weapons,Ticks,Milliseconds,NsPerUpdate,Measured,Expected,Checks,Failures\n");
+
+	if (FParse::Param(*Params, TEXT("statemachine")))
+	{
+		int32 NumWeapons = 100000;
+		FParse::Value(*Params, TEXT("weapons="), NumWeapons);
+		NumWeapons = FMath::Max(1, NumWeapons);
+
+		int32 NumTicks = 100;
+		FParse::Value(*Params, TEXT("ticks="), NumTicks);
+		NumTicks = FMath::Max(1, NumTicks);
+
+		int32 NumCases = 0;
+		const int32 NumFailures = CheckStateMachine(NumCases);
+		NumCheckFailures += NumFailures;
+
+		/* Weapons as the fire loop sees them, with trigger and reload input changing every tick */
+		FRandomStream Stream(1);
+		TArray<FWeaponStateInputs> Inputs;
+		TArray<EWeaponMachineState> States;
+		Inputs.SetNumUninitialized(NumWeapons);
+		States.Init(EWeaponMachineState::Idle, NumWeapons);
+
+		for (FWeaponStateInputs& Weapon : Inputs)
+		{
+			Weapon.bEquipped = Stream.FRand() < 0.9f;
+			Weapon.bPendingEquip = !Weapon.bEquipped;
+			Weapon.bWantsToFire = false;
+			Weapon.bPendingReload = false;
+			Weapon.bPawnCanFire = true;
+			Weapon.bPawnCanReload = true;
+			Weapon.MaxAmmoPerClip = 30;
+			Weapon.Ammo = 999;
+			Weapon.AmmoInClip = Stream.RandRange(0, 30);
+		}
+
+		TArray<uint8> TriggerPattern;
+		TriggerPattern.SetNumUninitialized(1024);
+		for (uint8& Trigger : TriggerPattern)
+		{
+			Trigger = (uint8)Stream.RandRange(0, 255);
+		}
+
+		uint32 NumEffects = 0;
+		const double StartTime = FPlatformTime::Seconds();
+
+		for (int32 Tick = 0; Tick < NumTicks; Tick++)
+		{
+			for (int32 i = 0; i < NumWeapons; i++)
+			{
+				FWeaponStateInputs& Weapon = Inputs[i];
+				const uint8 Trigger = TriggerPattern[(i + Tick) & 1023];
+				Weapon.bWantsToFire = (Trigger & 3) != 0;
+				Weapon.bPendingReload = Weapon.AmmoInClip == 0 || (Trigger & 0xf0) == 0;
+
+				const EWeaponMachineState Next = FWeaponStateMachine::DetermineState(States[i], Weapon);
+				NumEffects += FWeaponStateMachine::GetTransitionEffects(States[i], Next);
+				States[i] = Next;
+
+				if (Next == EWeaponMachineState::Firing && Weapon.AmmoInClip > 0)
+				{
+					FWeaponStateMachine::UseAmmo(Weapon.Ammo, Weapon.AmmoInClip);
+				}
+				else if (Next == EWeaponMachineState::Reloading)
+				{
+					Weapon.AmmoInClip += FWeaponStateMachine::GetReloadAmount(Weapon.Ammo, Weapon.AmmoInClip, Weapon.MaxAmmoPerClip);
+					States[i] = EWeaponMachineState::Idle;
+				}
+			}
+		}
+
+		const double Milliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		const double NsPerUpdate = Milliseconds * 1000000.0 / ((double)NumWeapons * NumTicks);
+
+		/* Printed so the updates cannot be optimized away */
+		UE_LOG(LogTemp, Display, TEXT("%u transition effects."), NumEffects);
+
+		const FString Row = FString::Printf(TEXT("StateMachine,Update,%d,%d,%.3f,%.2f,,,%d,%d"), NumWeapons, NumTicks, Milliseconds, NsPerUpdate, NumCases, NumFailures);
+		UE_LOG(LogTemp, Display, TEXT("%s"), *Row);
+		Csv += Row + TEXT("\n");
+	}
+
+	if (FParse::Param(*Params, TEXT("firerate")))
+	{
+		FString RpmParam = TEXT("700,1200");
+		FParse::Value(*Params, TEXT("rpm="), RpmParam);
+
+		FString FrameRatesParam = TEXT("20,30,60,120");
+		FParse::Value(*Params, TEXT("framerates="), FrameRatesParam);
+
+		float Seconds = 60.f;
+		FParse::Value(*Params, TEXT("seconds="), Seconds);
+
+		float TolerancePercent = 1.f;
+		FParse::Value(*Params, TEXT("tolerance="), TolerancePercent);
+
+		TArray<FString> RpmTokens;
+		RpmParam.ParseIntoArray(RpmTokens, TEXT(","), true);
+
+		TArray<FString> FrameRateTokens;
+		FrameRatesParam.ParseIntoArray(FrameRateTokens, TEXT(","), true);
+
+		for (const FString& RpmToken : RpmTokens)
+		{
+			const float ShotsPerMinute = FCString::Atof(*RpmToken);
+			if (ShotsPerMinute <= 0.f)
+			{
+				continue;
+			}
+
+			for (const FString& FrameRateToken : FrameRateTokens)
+			{
+				const float FrameRate = FCString::Atof(*FrameRateToken);
+				if (FrameRate <= 0.f)
+				{
+					continue;
+				}
+
+				/* As the weapon does it: the first shot on the trigger, then the scheduler one interval later.
+				   World time is accumulated per frame in a float like the engine's. */
+				const float Interval = 60.f / ShotsPerMinute;
+				const float DeltaSeconds = 1.f / FrameRate;
+				float Now = 0.f;
+				float NextShotTime = Interval;
+				float ShotTimes[AWeaponFireScheduler::MaxShotsPerFrame];
+				int32 NumShots = 1;
+				int32 NumCappedFrames = 0;
+				int32 NumFrames = 0;
+
+				const double StartTime = FPlatformTime::Seconds();
+
+				while (Now < Seconds)
+				{
+					Now += DeltaSeconds;
+					NumFrames++;
+
+					const int32 NumDue = AWeaponFireScheduler::CollectDueShots(NextShotTime, Interval, Now, ShotTimes);
+					NumShots += NumDue;
+					if (NumDue == AWeaponFireScheduler::MaxShotsPerFrame)
+					{
+						NumCappedFrames++;
+					}
+				}
+
+				const double Milliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+				/* Shots held over the whole run, counting the one on the trigger */
+				const float ExpectedShots = FMath::FloorToFloat(Now / Interval) + 1.f;
+				const float MeasuredRpm = NumShots * ShotsPerMinute / ExpectedShots;
+				const bool bRateOK = FMath::Abs(MeasuredRpm - ShotsPerMinute) <= ShotsPerMinute * TolerancePercent / 100.f;
+				const int32 NumFailures = (bRateOK ? 0 : 1) + (NumCappedFrames > 0 ? 1 : 0);
+
+				if (!bRateOK)
+				{
+					UE_LOG(LogTemp, Error, TEXT("%.0f rpm at %.0f Hz fired at %.1f rpm."), ShotsPerMinute, FrameRate, MeasuredRpm);
+				}
+				if (NumCappedFrames > 0)
+				{
+					UE_LOG(LogTemp, Error, TEXT("%.0f rpm at %.0f Hz hit MaxShotsPerFrame in %d frames."), ShotsPerMinute, FrameRate, NumCappedFrames);
+				}
+				NumCheckFailures += NumFailures;
+
+				const FString Row = FString::Printf(TEXT("FireRate,%.0frpm@%.0fHz,1,%d,%.3f,%.2f,%.1f,%.1f,2,%d"),
+					ShotsPerMinute, FrameRate, NumFrames, Milliseconds, Milliseconds * 1000000.0 / NumFrames, MeasuredRpm, ShotsPerMinute, NumFailures);
+				UE_LOG(LogTemp, Display, TEXT("%s"), *Row);
+				Csv += Row + TEXT("\n");
+			}
+		}
+	}
+
+	if (FParse::Param(*Params, TEXT("rewind")))
+	{
+		int32 NumCharacters = 16;
+		FParse::Value(*Params, TEXT("characters="), NumCharacters);
+		NumCharacters = FMath::Max(1, NumCharacters);
+
+		int32 NumHitboxes = 19;
+		FParse::Value(*Params, TEXT("hitboxes="), NumHitboxes);
+		NumHitboxes = FMath::Max(2, NumHitboxes);
+
+		int32 NumShots = 100000;
+		FParse::Value(*Params, TEXT("shots="), NumShots);
+		NumShots = FMath::Max(1, NumShots);
+
+		const float Tolerance = 10.f;
+
+		/* A column of capsules the height of a character, staggered a little like limbs around the spine */
+		TArray<FHitboxShape> Shapes;
+		const float BoxHeight = 180.f / NumHitboxes;
+		for (int32 i = 0; i < NumHitboxes; i++)
+		{
+			const FVector Offset((i % 3 - 1) * 15.f, 0.f, -90.f + i * BoxHeight);
+			Shapes.Add({ INDEX_NONE, Offset, Offset + FVector(0.f, 0.f, BoxHeight), 12.f });
+		}
+
+		TArray<FHitboxHistory> Histories;
+		Histories.SetNum(NumCharacters);
+		for (int32 i = 0; i < NumCharacters; i++)
+		{
+			Histories[i].Initialize(Shapes);
+			for (int32 Sample = 0; Sample < FHitboxHistory::MaxSamples; Sample++)
+			{
+				const float Time = Sample / RewindSampleRate;
+				Histories[i].Record(nullptr, FTransform(GetRewindCharacterLocation(i, NumCharacters, Time)), Time);
+			}
+		}
+
+		int32 NumCases = 0;
+		const int32 NumFailures = CheckRewind(Histories, Tolerance, NumCases);
+		NumCheckFailures += NumFailures;
+
+		/* Shots at a random character at a random time of the history, some off by up to a capsule and a half.
+		   Each is checked against every character as FindRewoundHit does. */
+		FRandomStream Stream(1);
+		TArray<FVector> ShotEnds;
+		TArray<float> ShotTimes;
+		ShotEnds.SetNumUninitialized(NumShots);
+		ShotTimes.SetNumUninitialized(NumShots);
+
+		const float HistorySeconds = (FHitboxHistory::MaxSamples - 1) / RewindSampleRate;
+		for (int32 i = 0; i < NumShots; i++)
+		{
+			ShotTimes[i] = Stream.FRand() * HistorySeconds;
+			const FVector Target = GetRewindCharacterLocation(Stream.RandRange(0, NumCharacters - 1), NumCharacters, ShotTimes[i]);
+			const FVector Miss(Stream.FRandRange(-40.f, 40.f), Stream.FRandRange(-40.f, 40.f), Stream.FRandRange(-100.f, 100.f));
+			ShotEnds[i] = (Target + Miss) * 2.f;
+		}
+
+		int32 NumHits = 0;
+		const double StartTime = FPlatformTime::Seconds();
+
+		for (int32 i = 0; i < NumShots; i++)
+		{
+			float NearestDistSquared = MAX_flt;
+			for (const FHitboxHistory& History : Histories)
+			{
+				FVector ShotPoint;
+				if (History.SegmentHits(FVector::ZeroVector, ShotEnds[i], ShotTimes[i], Tolerance, &ShotPoint))
+				{
+					NearestDistSquared = FMath::Min(NearestDistSquared, ShotPoint.SizeSquared());
+				}
+			}
+
+			if (NearestDistSquared < MAX_flt)
+			{
+				NumHits++;
+			}
+		}
+
+		const double Milliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		const FString Row = FString::Printf(TEXT("Rewind,%dHitboxes,%d,%d,%.3f,%.2f,%d,,%d,%d"),
+			NumHitboxes, NumCharacters, NumShots, Milliseconds, Milliseconds * 1000000.0 / NumShots, NumHits, NumCases, NumFailures);
+		UE_LOG(LogTemp, Display, TEXT("%s"), *Row);
+		Csv += Row + TEXT("\n");
+	}
+
+	if (FParse::Param(*Params, TEXT("projectiles")))
+	{
+		int32 NumLaunches = 10000;
+		FParse::Value(*Params, TEXT("launches="), NumLaunches);
+		NumLaunches = FMath::Max(1, NumLaunches);
+
+		/* Projectiles alive at once, the pool's default size */
+		int32 NumInFlight = 128;
+		FParse::Value(*Params, TEXT("inflight="), NumInFlight);
+		NumInFlight = FMath::Max(1, NumInFlight);
+
+		/* A bare world to spawn into, there is no game state so the pool keeps its own defaults */
+		UWorld* const World = UWorld::CreateWorld(EWorldType::Game, false);
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+		World->InitializeActorsForPlay(FURL());
+		World->BeginPlay();
+
+		AGunslingersProjectilePool* const Pool = World->SpawnActor<AGunslingersProjectilePool>();
+		const TSubclassOf<AGunslingersProjectile> ProjectileClass = Pool->GetProjectileClass();
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+		/* Spawned: each launch spawns a projectile and the oldest in flight is destroyed, as its life span would */
+		TArray<AGunslingersProjectile*> InFlight;
+		InFlight.Reserve(NumInFlight);
+
+		const double SpawnStart = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumLaunches; i++)
+		{
+			if (InFlight.Num() >= NumInFlight)
+			{
+				InFlight[0]->Destroy();
+				InFlight.RemoveAt(0, 1, false);
+			}
+			InFlight.Add(World->SpawnActor<AGunslingersProjectile>(ProjectileClass, FVector(0.f, 0.f, 1000.f), FRotator::ZeroRotator, SpawnParams));
+		}
+		const double SpawnMs = (FPlatformTime::Seconds() - SpawnStart) * 1000.0;
+
+		const double SpawnGCStart = FPlatformTime::Seconds();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		const double SpawnGCMs = (FPlatformTime::Seconds() - SpawnGCStart) * 1000.0;
+
+		for (AGunslingersProjectile* Projectile : InFlight)
+		{
+			Projectile->Destroy();
+		}
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+		/* Pooled: the pool relaunches the oldest in flight once it holds NumInFlight */
+		Pool->SetMaxProjectiles(NumInFlight);
+		int32 MaxPoolSize = 0;
+
+		const double PoolStart = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumLaunches; i++)
+		{
+			Pool->LaunchProjectile(FVector(0.f, 0.f, 1000.f), FRotator::ZeroRotator, nullptr, nullptr);
+			MaxPoolSize = FMath::Max(MaxPoolSize, Pool->GetNumProjectiles());
+		}
+		const double PoolMs = (FPlatformTime::Seconds() - PoolStart) * 1000.0;
+
+		const double PoolGCStart = FPlatformTime::Seconds();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		const double PoolGCMs = (FPlatformTime::Seconds() - PoolGCStart) * 1000.0;
+
+		/* The pool never grows past its size, however many launches */
+		const int32 NumFailures = MaxPoolSize > NumInFlight ? 1 : 0;
+		if (NumFailures > 0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("The projectile pool grew to %d projectiles for %d in flight."), MaxPoolSize, NumInFlight);
+		}
+		NumCheckFailures += NumFailures;
+
+		/* Measured is the garbage collection after the launches, in milliseconds */
+		const FString SpawnRow = FString::Printf(TEXT("Projectiles,Spawn,%d,%d,%.3f,%.2f,%.3f,,0,0"),
+			NumInFlight, NumLaunches, SpawnMs, SpawnMs * 1000000.0 / NumLaunches, SpawnGCMs);
+		const FString PoolRow = FString::Printf(TEXT("Projectiles,Pool,%d,%d,%.3f,%.2f,%.3f,,1,%d"),
+			NumInFlight, NumLaunches, PoolMs, PoolMs * 1000000.0 / NumLaunches, PoolGCMs, NumFailures);
+		UE_LOG(LogTemp, Display, TEXT("%s"), *SpawnRow);
+		UE_LOG(LogTemp, Display, TEXT("%s"), *PoolRow);
+		Csv += SpawnRow + TEXT("\n") + PoolRow + TEXT("\n");
+
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	if (!CsvPath.IsEmpty() && !FFileHelper::SaveStringToFile(Csv, *CsvPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Could not write %s."), *CsvPath);
+		return 1;
+	}
+
+	if (NumCheckFailures > 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%d weapon checks failed."), NumCheckFailures);
+		return 1;
+	}
+
+	return 0;
+}
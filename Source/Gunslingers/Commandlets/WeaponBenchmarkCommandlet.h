@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "WeaponBenchmarkCommandlet.generated.h"
+
+/**
+* Checks and times the weapon logic headless and writes a CSV report.
+*
+* UE4Editor-Cmd Gunslingers.uproject -run=WeaponBenchmark -nullrhi -statemachine -weapons=100000 -ticks=100 -csv=Saved/Weapons.csv
+*
+* -statemachine walks every state and input combination through FWeaponStateMachine, checks the chosen
+* state and the transition table effects against the firing rules, then times one state update per weapon
+* over -weapons= weapons for -ticks= ticks.
+*
+* -firerate drives AWeaponFireScheduler's shot timing for -seconds= of held trigger at each of -framerates=
+* (default 20,30,60,120) for each of -rpm= (default 700,1200), and fails when the shots per minute miss
+* the weapon's rate by more than -tolerance= percent or a frame hits MaxShotsPerFrame.
+*
+* -rewind records a full FHitboxHistory of -hitboxes= (default 19) capsules for -characters= (default 16)
+* strafing characters, checks that rewound shots hit where a character was and not where it went and that
+* rewind times are clamped, then times -shots= (default 100000) shots each checked against every character.
+*
+* -projectiles times -launches= (default 10000) projectile launches with -inflight= (default 128) alive at once,
+* spawned and destroyed against relaunched from AGunslingersProjectilePool, and the garbage collection after each.
+*/
+UCLASS()
+class UWeaponBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UWeaponBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -2,9 +2,11 @@
 
 #include "Gunslingers.h"
 #include "GunslingersGameMode.h"
+#include "GunslingersGameState.h"
 #include "GunslingersHUD.h"
-#include "World/Tile.h"
+#include "GunslingersProjectile.h"
 #include "Characters/PlayerCharacter.h"
+#include "EngineUtils.h"
 
 AGunslingersGameMode::AGunslingersGameMode()
 	: Super()
@@ -13,110 +15,97 @@ AGunslingersGameMode::AGunslingersGameMode()
 	static ConstructorHelpers::FClassFinder<APawn> PlayerPawnClassFinder(TEXT("/Game/Dynamic/Characters/Player/Player_BP"));
 	DefaultPawnClass = PlayerPawnClassFinder.Class;
 
+	// the projectile the content fires, what the pool prewarms
+	static ConstructorHelpers::FClassFinder<AGunslingersProjectile> ProjectileClassFinder(TEXT("/Game/Dynamic/Items/Projectiles/BallProjectile_BP"));
+	PooledProjectileClass = ProjectileClassFinder.Class;
+
 	// use our custom HUD class
 	HUDClass = AGunslingersHUD::StaticClass();
+
+	// the game state owns the layout seed and builds the arena on server and clients
+	GameStateClass = AGunslingersGameState::StaticClass();
 }
 
-void AGunslingersGameMode::BeginPlay()
+void AGunslingersGameMode::InitGameState()
 {
-	// Call the base class  
-	Super::BeginPlay();
+	Super::InitGameState();
 
-	if (World != NULL)
+	AGunslingersGameState* const GS = GetGameState<AGunslingersGameState>();
+	if (GS)
 	{
-		SpawnLevelTiles();
-		SpawnLevelWalls();
+		// 0 is reserved for 'no seed yet' so clients always receive a change to react to
+		GS->SetLayoutSeed(FixedLayoutSeed != 0 ? FixedLayoutSeed : FMath::RandRange(1, MAX_int32));
+		GS->OnLevelReady.AddDynamic(this, &AGunslingersGameMode::OnLevelReady);
 	}
 }
 
-void AGunslingersGameMode::SpawnLevelTiles()
+void AGunslingersGameMode::ResetRound(bool bNewLayout)
 {
-	NumberOfTiles = 3 * NumberOfPlayers;
+	AGunslingersGameState* const GS = GetGameState<AGunslingersGameState>();
 
-	for (int32 i = 0; i < NumberOfTiles; i++) {
-			World->SpawnActor<ATile>(TileBlueprint, TileTransform, TileRotation);
-			AllocatedTransforms.Add(TileTransform);
-			SetRandomTransform();
+	if (GS && bNewLayout)
+	{
+		/* Players are reset from OnLevelReady once the tiles are in their new place */
+		bPendingRoundReset = true;
+		GS->SetLayoutSeed(FMath::RandRange(1, MAX_int32));
 	}
-}
-
-void AGunslingersGameMode::SpawnLevelWalls()
-{
-	for (FVector AllocatedTile : AllocatedTransforms) {
-
-		TileTransform = AllocatedTile;
-		OffsetLocation(true, true);
-		CheckAllocation();
-		if (IsAllocated == false) { World->SpawnActor<ATile>(WallBlueprint, TileTransform, TileRotation); }
-		else { UE_LOG(LogTemp, Warning, TEXT("%f, %f, %f is allocated."), TileTransform.X, TileTransform.Y, TileTransform.Z); }
-
-		TileTransform = AllocatedTile;
-		OffsetLocation(true, false);
-		CheckAllocation();
-		if (IsAllocated == false) { World->SpawnActor<ATile>(WallBlueprint, TileTransform, TileRotation); }
-		else { UE_LOG(LogTemp, Warning, TEXT("%f, %f, %f is allocated."), TileTransform.X, TileTransform.Y, TileTransform.Z); }
-
-		TileTransform = AllocatedTile;
-		OffsetLocation(false, true);
-		CheckAllocation();
-		if (IsAllocated == false) { World->SpawnActor<ATile>(WallBlueprint, TileTransform, TileRotation); }
-		else { UE_LOG(LogTemp, Warning, TEXT("%f, %f, %f is allocated."), TileTransform.X, TileTransform.Y, TileTransform.Z); }
-
-		TileTransform = AllocatedTile;
-		OffsetLocation(false, false);
-		CheckAllocation();
-		if (IsAllocated == false) { World->SpawnActor<ATile>(WallBlueprint, TileTransform, TileRotation); }
-		else { UE_LOG(LogTemp, Warning, TEXT("%f, %f, %f is allocated."), TileTransform.X, TileTransform.Y, TileTransform.Z); }
+	else
+	{
+		ResetPlayersForRound();
 	}
-	return;
 }
 
-void AGunslingersGameMode::SetRandomTransform()
+void AGunslingersGameMode::ResetPlayersForRound()
 {
-	IsXDirection = FMath::RandBool();
-	IsPositive = FMath::RandBool();
-	RotationOffset = FMath::RandRange(0, 3);
-
-	TileRotation.Yaw = 90 * RotationOffset;
-
-	OffsetLocation(IsXDirection, IsPositive);
-	
-	do {
-		CheckAllocation();
-		if (IsAllocated == true) { OffsetLocation(IsXDirection, IsPositive); }
-	} while (IsAllocated == true);
-
-	return;
+	for (TActorIterator<APlayerController> It(GetWorld()); It; ++It)
+	{
+		APlayerController* const PC = *It;
+		APlayerCharacter* const Char = Cast<APlayerCharacter>(PC->GetPawn());
+
+		if (Char)
+		{
+			Char->ResetForNewRound();
+
+			AActor* const StartSpot = FindPlayerStart(PC);
+			if (StartSpot)
+			{
+				Char->TeleportTo(StartSpot->GetActorLocation(), StartSpot->GetActorRotation());
+				PC->ClientSetRotation(StartSpot->GetActorRotation());
+			}
+		}
+		else if (PC->GetPawn() == nullptr && !MustSpectate(PC) && PlayerCanRestart(PC))
+		{
+			RestartPlayer(PC);
+		}
+	}
 }
 
-FVector AGunslingersGameMode::OffsetLocation(bool DirectionX, bool Positive)
+bool AGunslingersGameMode::PlayerCanRestart_Implementation(APlayerController* Player)
 {
-	if (DirectionX == true && Positive == true) {
-		TileTransform.X += TileOffset;
-	}
-	else if (DirectionX == true && Positive == false) {
-		TileTransform.X -= TileOffset;
-	}
-	else if (DirectionX == false && Positive == true) {
-		TileTransform.Y += TileOffset;
-	}
-	else if (DirectionX == false && Positive == false) {
-		TileTransform.Y -= TileOffset;
+	const AGunslingersGameState* const GS = GetGameState<AGunslingersGameState>();
+	if (GS && !GS->IsLevelReady())
+	{
+		return false;
 	}
 
-	return TileTransform;
+	return Super::PlayerCanRestart_Implementation(Player);
 }
 
-void AGunslingersGameMode::CheckAllocation()
+void AGunslingersGameMode::OnLevelReady()
 {
-	IsAllocated = false;
-	for (FVector Allocated : AllocatedTransforms) {
-		if (TileTransform == Allocated) {
-			IsAllocated = true;
+	if (bPendingRoundReset)
+	{
+		bPendingRoundReset = false;
+		ResetPlayersForRound();
+		return;
+	}
 
-			return;
+	for (TActorIterator<APlayerController> It(GetWorld()); It; ++It)
+	{
+		APlayerController* const PC = *It;
+		if (PC->GetPawn() == nullptr && !MustSpectate(PC) && PlayerCanRestart(PC))
+		{
+			RestartPlayer(PC);
 		}
 	}
-
-	return;
 }
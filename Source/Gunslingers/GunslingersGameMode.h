@@ -11,41 +11,190 @@ class AGunslingersGameMode : public AGameModeBase
 public:
 	AGunslingersGameMode();
 
-	virtual void BeginPlay() override;
+	virtual void InitGameState() override;
+
+	/* Start a new round on the current map without travelling. Keeps every connection, recycles
+	   living pawns and their weapons, and either keeps the arena or moves its tiles into a new layout. */
+	UFUNCTION(BlueprintCallable, Category = "Game")
+	void ResetRound(bool bNewLayout);
+
+	/* Players are held back until the arena has finished spawning */
+	virtual bool PlayerCanRestart_Implementation(APlayerController* Player) override;
 
 	UPROPERTY(EditDefaultsOnly, Category = "Game")
 	int32 NumberOfPlayers = 8;
 
 	UPROPERTY(EditDefaultsOnly, Category = "Level Setup")
 	TSubclassOf<class ATile> TileBlueprint;
-	
+
 	UPROPERTY(EditDefaultsOnly, Category = "Level Setup")
 	TSubclassOf<class ATile> WallBlueprint;
 
 	UPROPERTY(EditDefaultsOnly, Category = "Level Setup")
 	float TileOffset = 4000.;
 
+	/* Seed the arena is generated from on every machine. 0 picks a new random seed each match. */
+	UPROPERTY(EditDefaultsOnly, Category = "Level Setup")
+	int32 FixedLayoutSeed = 0;
+
+	/* Load layouts from Saved/LayoutCache when one matches the seed and tile count, and save new ones there.
+	   Meant for fixed playlist seeds, random seeds rarely repeat. */
+	UPROPERTY(EditDefaultsOnly, Category = "Level Setup")
+	bool bCacheLayouts = false;
+
+	/* Milliseconds per frame spent spawning tiles and walls while the arena is built */
+	UPROPERTY(EditDefaultsOnly, Category = "Level Setup")
+	float LevelSpawnBudgetMs = 4.f;
+
+	/* Draw floor and wall cells as instances of one component per tile type instead of one ATile actor per cell */
+	UPROPERTY(EditDefaultsOnly, Category = "Level Setup")
+	bool bBatchTiles = false;
+
+	/* Mesh used for floor cells when tiles are batched */
+	UPROPERTY(EditDefaultsOnly, Category = "Level Setup", meta = (EditCondition = "bBatchTiles"))
+	UStaticMesh* TileBatchMesh = nullptr;
+
+	/* Mesh used for wall cells when tiles are batched. Straight runs of walls become one instance scaled
+	   along the run, so the mesh must be one cell long along X and Y */
+	UPROPERTY(EditDefaultsOnly, Category = "Level Setup", meta = (EditCondition = "bBatchTiles"))
+	UStaticMesh* WallBatchMesh = nullptr;
+
+	/* Hold navmesh updates while the arena spawns and build the whole arena once when it is ready,
+	   instead of rebuilding the navmesh tiles under each new floor and wall as it appears */
+	UPROPERTY(EditDefaultsOnly, Category = "Level Setup")
+	bool bDeferNavigationBuild = true;
+
+	/* On clients, hide and disable collision of arena chunks far from every local player */
+	UPROPERTY(EditDefaultsOnly, Category = "Level Streaming")
+	bool bStreamArenaChunks = false;
+
+	/* Width of a streaming chunk in grid cells */
+	UPROPERTY(EditDefaultsOnly, Category = "Level Streaming", meta = (EditCondition = "bStreamArenaChunks", ClampMin = "1"))
+	int32 ChunkSizeInCells = 8;
+
+	/* Chunks within this many chunks of a local player stay visible */
+	UPROPERTY(EditDefaultsOnly, Category = "Level Streaming", meta = (EditCondition = "bStreamArenaChunks", ClampMin = "0"))
+	int32 StreamingRadiusInChunks = 2;
+
+	/* Seconds between visibility updates of the arena chunks */
+	UPROPERTY(EditDefaultsOnly, Category = "Level Streaming", meta = (EditCondition = "bStreamArenaChunks"))
+	float StreamingUpdateInterval = 0.25f;
+
+	/* Collect every weapon's shot traces over the frame and run them as one batch of async traces,
+	   hits are delivered a frame later */
+	UPROPERTY(EditDefaultsOnly, Category = "Performance")
+	bool bBatchWeaponTraces = true;
+
+	/* Fire automatic weapons from one scheduler that keeps exact shot times, instead of a timer per weapon
+	   that can only refire on frame boundaries */
+	UPROPERTY(EditDefaultsOnly, Category = "Performance")
+	bool bScheduleWeaponFire = true;
+
+	/* Recycle muzzle flash, impact and decal components instead of spawning them per shot */
+	UPROPERTY(EditDefaultsOnly, Category = "Effects")
+	bool bPoolWeaponEffects = true;
+
+	/* Most muzzle flashes alive at once, the oldest is restarted beyond this */
+	UPROPERTY(EditDefaultsOnly, Category = "Effects", meta = (EditCondition = "bPoolWeaponEffects", ClampMin = "1"))
+	int32 MaxMuzzleEffects = 16;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Effects", meta = (EditCondition = "bPoolWeaponEffects", ClampMin = "1"))
+	int32 MaxImpactEffects = 32;
+
+	/* Bullet holes left in the level, the oldest is moved to the newest impact */
+	UPROPERTY(EditDefaultsOnly, Category = "Effects", meta = (EditCondition = "bPoolWeaponEffects", ClampMin = "1"))
+	int32 MaxImpactDecals = 64;
+
+	/* Muzzle flashes and impacts further than this from every local player are skipped */
+	UPROPERTY(EditDefaultsOnly, Category = "Effects", meta = (EditCondition = "bPoolWeaponEffects"))
+	float EffectCullDistance = 10000.f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Effects", meta = (EditCondition = "bPoolWeaponEffects"))
+	float DecalCullDistance = 5000.f;
+
+	/* Launch projectiles from a prewarmed pool and return them on hit or timeout instead of destroying them.
+	   Only projectiles fired through AGunslingersProjectilePool::SpawnProjectile, as AWeaponProjectile does, are pooled. */
+	UPROPERTY(EditDefaultsOnly, Category = "Effects")
+	bool bPoolProjectiles = true;
+
+	/* Class the pool holds, projectiles of other classes are still spawned. Defaults to BallProjectile_BP. */
+	UPROPERTY(EditDefaultsOnly, Category = "Effects", meta = (EditCondition = "bPoolProjectiles"))
+	TSubclassOf<class AGunslingersProjectile> PooledProjectileClass;
+
+	/* Spawned hidden when the match starts */
+	UPROPERTY(EditDefaultsOnly, Category = "Effects", meta = (EditCondition = "bPoolProjectiles", ClampMin = "0"))
+	int32 NumPrewarmedProjectiles = 32;
+
+	/* Beyond this many the oldest projectile in flight is relaunched */
+	UPROPERTY(EditDefaultsOnly, Category = "Effects", meta = (EditCondition = "bPoolProjectiles", ClampMin = "1"))
+	int32 MaxPooledProjectiles = 128;
+
+	/* Check shots streamed by clients against the hitboxes of every character as they were when the shooter fired */
+	UPROPERTY(EditDefaultsOnly, Category = "Lag Compensation")
+	bool bLagCompensateHits = true;
+
+	/* Furthest back a shot is rewound, higher pings are checked against this old a pose */
+	UPROPERTY(EditDefaultsOnly, Category = "Lag Compensation", meta = (EditCondition = "bLagCompensateHits"))
+	float MaxRewindSeconds = 0.25f;
+
+	/* How far behind the server other characters are drawn on clients, added to the shooter's ping for its rewind */
+	UPROPERTY(EditDefaultsOnly, Category = "Lag Compensation", meta = (EditCondition = "bLagCompensateHits"))
+	float RewindInterpolationSeconds = 0.1f;
+
+	/* Slack on top of ping and interpolation before a claimed shot time is moved forward, covers ping jitter */
+	UPROPERTY(EditDefaultsOnly, Category = "Lag Compensation", meta = (EditCondition = "bLagCompensateHits"))
+	float RewindToleranceSeconds = 0.05f;
+
+	/* Extra radius around each hitbox accepted as a hit, covers interpolation error */
+	UPROPERTY(EditDefaultsOnly, Category = "Lag Compensation", meta = (EditCondition = "bLagCompensateHits"))
+	float HitboxTolerance = 10.f;
+
+	/* Fold every pawn noise into a grid of the loudest noise per cell that guards sample, instead of
+	   broadcasting each noise to every pawn sensing listener */
+	UPROPERTY(EditDefaultsOnly, Category = "AI")
+	bool bAggregateNoise = true;
+
+	/* Seconds a noise in the field takes to fade out */
+	UPROPERTY(EditDefaultsOnly, Category = "AI", meta = (EditCondition = "bAggregateNoise"))
+	float NoiseDecaySeconds = 2.f;
+
+	/* Throttle or switch off ticks of tiles, weapons, characters and patrol components by their distance to players */
+	UPROPERTY(EditDefaultsOnly, Category = "Performance")
+	bool bManageTickSignificance = false;
+
+	/* Milliseconds per frame spent rescoring ticks, the rest are scored on later frames */
+	UPROPERTY(EditDefaultsOnly, Category = "Performance", meta = (EditCondition = "bManageTickSignificance"))
+	float SignificanceBudgetMs = 0.25f;
+
+	/* Within this distance of a player, or on a client's screen, ticks run every frame */
+	UPROPERTY(EditDefaultsOnly, Category = "Performance", meta = (EditCondition = "bManageTickSignificance"))
+	float FullTickDistance = 3000.f;
+
+	/* Within this distance ticks run every ReducedTickInterval seconds */
+	UPROPERTY(EditDefaultsOnly, Category = "Performance", meta = (EditCondition = "bManageTickSignificance"))
+	float ReducedTickDistance = 8000.f;
+
+	/* Within this distance ticks run every LowTickInterval seconds, beyond it they stop unless they do gameplay work */
+	UPROPERTY(EditDefaultsOnly, Category = "Performance", meta = (EditCondition = "bManageTickSignificance"))
+	float LowTickDistance = 20000.f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Performance", meta = (EditCondition = "bManageTickSignificance"))
+	float ReducedTickInterval = 0.1f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Performance", meta = (EditCondition = "bManageTickSignificance"))
+	float LowTickInterval = 0.5f;
+
 protected:
 
-	void SpawnLevelTiles();
-	void SpawnLevelWalls();
+	/* Spawn every player that was waiting for the arena */
+	UFUNCTION()
+	void OnLevelReady();
+
+	/* Move living pawns back to a start spot with fresh health and ammo, restart the rest */
+	void ResetPlayersForRound();
 
 private:
-	int32 NumberOfTiles = 12;
-	int32 RotationOffset = 0;
-
-	TArray<FVector> AllocatedTransforms;
-
-	bool IsXDirection;
-	bool IsPositive;
-	bool IsAllocated;
-	
-	FRotator TileRotation;
-	FVector TileTransform;
-	FVector OffsetLocation(bool DirectionX, bool Positive);
-	
-	void SetRandomTransform();
-	void CheckAllocation();
-
-	UWorld* const World = GetWorld();
-};
\ No newline at end of file
+
+	/* Players are reset once the new layout is ready */
+	bool bPendingRoundReset = false;
+};
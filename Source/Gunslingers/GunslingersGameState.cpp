@@ -0,0 +1,708 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+
+#include "Gunslingers.h"
+#include "GunslingersGameState.h"
+#include "GunslingersGameMode.h"
+#include "GunslingersProjectilePool.h"
+#include "World/Tile.h"
+#include "World/TileBatchManager.h"
+#include "World/TickSignificanceManager.h"
+#include "World/NoiseFieldManager.h"
+#include "Items/Weapons/WeaponTraceManager.h"
+#include "Items/Weapons/WeaponFireScheduler.h"
+#include "Items/Weapons/WeaponEffectsPool.h"
+#include "AI/Navigation/NavigationSystem.h"
+#include "EngineUtils.h"
+
+AGunslingersGameState::AGunslingersGameState()
+{
+	LayoutSeed = 0;
+	LayoutChecksum = 0;
+	LayoutChecksumSeed = 0;
+	bLevelGenerated = false;
+	TileBatchManager = nullptr;
+	TickSignificanceManager = nullptr;
+	WeaponTraceManager = nullptr;
+	WeaponFireScheduler = nullptr;
+	WeaponEffectsPool = nullptr;
+	ProjectilePool = nullptr;
+	NoiseFieldManager = nullptr;
+	TileBatchMesh = nullptr;
+	WallBatchMesh = nullptr;
+	bLevelReady = false;
+	bNavigationReady = false;
+	bNavigationDeferred = false;
+	NavigationStartTime = 0.0;
+	NumSpawned = 0;
+	SpawnBudgetSeconds = 0.004;
+	GenerationStartTime = 0.0;
+
+	/* Only ticks while the arena is being spawned */
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	TileOffset = 4000.f;
+	NumberOfTiles = 12;
+
+	bStreamChunks = false;
+	ChunkSizeInCells = 8;
+	StreamingRadiusInChunks = 2;
+}
+
+void AGunslingersGameState::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const AGunslingersGameMode* const Settings = GetDefaultGameMode<AGunslingersGameMode>();
+	if (Settings && Settings->bBatchWeaponTraces)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = this;
+		WeaponTraceManager = GetWorld()->SpawnActor<AWeaponTraceManager>(SpawnParams);
+	}
+
+	if (Settings && Settings->bScheduleWeaponFire)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = this;
+		WeaponFireScheduler = GetWorld()->SpawnActor<AWeaponFireScheduler>(SpawnParams);
+	}
+
+	/* Nothing is drawn on a dedicated server */
+	if (Settings && Settings->bPoolWeaponEffects && GetNetMode() != NM_DedicatedServer)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = this;
+		WeaponEffectsPool = GetWorld()->SpawnActor<AWeaponEffectsPool>(SpawnParams);
+	}
+
+	if (Settings && Settings->bPoolProjectiles)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = this;
+		ProjectilePool = GetWorld()->SpawnActor<AGunslingersProjectilePool>(SpawnParams);
+	}
+
+	/* Only the server's guards listen */
+	if (Settings && Settings->bAggregateNoise && Role == ROLE_Authority)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = this;
+		NoiseFieldManager = GetWorld()->SpawnActor<ANoiseFieldManager>(SpawnParams);
+	}
+
+	/* Clients start generating as soon as the seed replicates */
+	if (Role == ROLE_Authority)
+	{
+		GenerateLevel();
+	}
+}
+
+void AGunslingersGameState::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	/* Auto update is a global of the navigation system, ending mid spawn would leave it off for the editor too */
+	if (bNavigationDeferred)
+	{
+		UNavigationSystem::SetNavigationAutoUpdateEnabled(true, GetWorld()->GetNavigationSystem());
+		bNavigationDeferred = false;
+	}
+
+	GetWorldTimerManager().ClearTimer(TimerHandle_NavigationBuild);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AGunslingersGameState::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (LayoutTask.IsValid() && LayoutTask.IsReady())
+	{
+		const FLevelLayoutPtr NewLayout = LayoutTask.Get();
+		LayoutTask = TFuture<FLevelLayoutPtr>();
+		ConsumeLayout(NewLayout);
+	}
+
+	if (Layout.IsValid() && !bLevelReady)
+	{
+		SpawnPendingTiles();
+	}
+}
+
+void AGunslingersGameState::SetLayoutSeed(int32 NewSeed)
+{
+	if (Role == ROLE_Authority && NewSeed != LayoutSeed)
+	{
+		LayoutSeed = NewSeed;
+
+		if (bLevelGenerated)
+		{
+			ResetLayout();
+			GenerateLevel();
+		}
+	}
+}
+
+int32 AGunslingersGameState::GetLayoutSeed() const
+{
+	return LayoutSeed;
+}
+
+uint32 AGunslingersGameState::GetLocalLayoutChecksum() const
+{
+	return Layout.IsValid() ? Layout->Checksum : 0;
+}
+
+const FLevelLayout& AGunslingersGameState::GetLayout() const
+{
+	static const FLevelLayout EmptyLayout;
+	return Layout.IsValid() ? *Layout : EmptyLayout;
+}
+
+const FTileGraph& AGunslingersGameState::GetTileGraph() const
+{
+	return TileGraph;
+}
+
+bool AGunslingersGameState::IsNavigationReady() const
+{
+	return bNavigationReady;
+}
+
+AWeaponTraceManager* AGunslingersGameState::GetWeaponTraceManager() const
+{
+	return WeaponTraceManager;
+}
+
+AWeaponFireScheduler* AGunslingersGameState::GetWeaponFireScheduler() const
+{
+	return WeaponFireScheduler;
+}
+
+AWeaponEffectsPool* AGunslingersGameState::GetWeaponEffectsPool() const
+{
+	return WeaponEffectsPool;
+}
+
+AGunslingersProjectilePool* AGunslingersGameState::GetProjectilePool() const
+{
+	return ProjectilePool;
+}
+
+ANoiseFieldManager* AGunslingersGameState::GetNoiseFieldManager() const
+{
+	return NoiseFieldManager;
+}
+
+ATickSignificanceManager* AGunslingersGameState::GetTickSignificanceManager() const
+{
+	return TickSignificanceManager;
+}
+
+bool AGunslingersGameState::IsLevelReady() const
+{
+	return bLevelReady;
+}
+
+float AGunslingersGameState::GetLevelProgress() const
+{
+	if (bLevelReady)
+	{
+		return 1.f;
+	}
+
+	return PendingSpawns.Num() > 0 ? (float)NumSpawned / PendingSpawns.Num() : 0.f;
+}
+
+void AGunslingersGameState::OnRep_LayoutSeed()
+{
+	if (bLevelGenerated)
+	{
+		ResetLayout();
+	}
+
+	GenerateLevel();
+}
+
+void AGunslingersGameState::OnRep_LayoutChecksum()
+{
+	VerifyLayoutChecksum();
+}
+
+void AGunslingersGameState::GenerateLevel()
+{
+	UWorld* const World = GetWorld();
+	const AGunslingersGameMode* const Settings = GetDefaultGameMode<AGunslingersGameMode>();
+
+	if (bLevelGenerated || LayoutSeed == 0 || World == nullptr || Settings == nullptr)
+	{
+		return;
+	}
+
+	TileBlueprint = Settings->TileBlueprint;
+	WallBlueprint = Settings->WallBlueprint;
+	TileOffset = Settings->TileOffset;
+	NumberOfTiles = 3 * Settings->NumberOfPlayers;
+	SpawnBudgetSeconds = FMath::Max(0.f, Settings->LevelSpawnBudgetMs) / 1000.0;
+
+	/* The server keeps the whole arena, it has to trace and move pawns everywhere */
+	bStreamChunks = Settings->bStreamArenaChunks && GetNetMode() == NM_Client;
+	ChunkSizeInCells = FMath::Max(1, Settings->ChunkSizeInCells);
+	StreamingRadiusInChunks = FMath::Max(0, Settings->StreamingRadiusInChunks);
+
+	if (Settings->bBatchTiles && TileBatchManager == nullptr)
+	{
+		TileBatchMesh = Settings->TileBatchMesh;
+		WallBatchMesh = Settings->WallBatchMesh;
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = this;
+		TileBatchManager = World->SpawnActor<ATileBatchManager>(SpawnParams);
+	}
+
+	if (Settings->bManageTickSignificance && TickSignificanceManager == nullptr)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = this;
+		TickSignificanceManager = World->SpawnActor<ATickSignificanceManager>(SpawnParams);
+	}
+
+	bLevelGenerated = true;
+
+	GenerationStartTime = FPlatformTime::Seconds();
+
+	/* The walk runs on a worker, Tick picks the result up */
+	LayoutTask = FLevelLayoutGenerator::GenerateAsync(LayoutSeed, NumberOfTiles, Settings->bCacheLayouts);
+	SetActorTickEnabled(true);
+}
+
+void AGunslingersGameState::ConsumeLayout(const FLevelLayoutPtr& NewLayout)
+{
+	const AGunslingersGameMode* const Settings = GetDefaultGameMode<AGunslingersGameMode>();
+
+	Layout = NewLayout;
+
+	QueueLayoutSpawns();
+
+	/* Only the server runs AI */
+	if (Role == ROLE_Authority)
+	{
+		TileGraph.Build(*Layout);
+	}
+
+	if (Role == ROLE_Authority && Settings && Settings->bDeferNavigationBuild)
+	{
+		BeginNavigationUpdates();
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Layout of %d tiles for seed %d ready in %.2f ms, spawning %d actors."),
+		Layout->TileCells.Num(), LayoutSeed, (FPlatformTime::Seconds() - GenerationStartTime) * 1000.0, PendingSpawns.Num());
+
+	if (Role == ROLE_Authority)
+	{
+		LayoutChecksum = Layout->Checksum;
+		LayoutChecksumSeed = LayoutSeed;
+	}
+	else
+	{
+		VerifyLayoutChecksum();
+	}
+}
+
+void AGunslingersGameState::VerifyLayoutChecksum()
+{
+	/* The server has not finished the layout for this seed yet */
+	if (!Layout.IsValid() || LayoutChecksum == 0 || LayoutChecksumSeed != LayoutSeed)
+	{
+		return;
+	}
+
+	if (LayoutChecksum != Layout->Checksum)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Layout mismatch for seed %d: server checksum %08x, client checksum %08x."), LayoutSeed, LayoutChecksum, Layout->Checksum);
+	}
+}
+
+void AGunslingersGameState::SpawnPendingTiles()
+{
+	UWorld* const World = GetWorld();
+	const double StartTime = FPlatformTime::Seconds();
+
+	/* Always place at least one actor per frame so a zero budget still finishes */
+	while (NumSpawned < PendingSpawns.Num())
+	{
+		const FPendingTileSpawn& Pending = PendingSpawns[NumSpawned];
+		if (TileBatchManager && Pending.BatchMesh)
+		{
+			TileBatchManager->AddTileInstance(Pending.Class, Pending.BatchMesh, Pending.Transform, Pending.ChunkIndex);
+		}
+		else
+		{
+			ATile* Tile = TakeReusableTile(Pending.Class);
+			if (Tile)
+			{
+				Tile->SetActorTransform(Pending.Transform);
+				Tile->SetActorHiddenInGame(false);
+				Tile->SetActorEnableCollision(true);
+
+				/* The significance manager owns tile ticks when there is one */
+				if (TickSignificanceManager == nullptr)
+				{
+					Tile->SetActorTickEnabled(true);
+				}
+			}
+			else
+			{
+				Tile = World->SpawnActor<ATile>(Pending.Class, Pending.Transform);
+			}
+
+			if (Tile)
+			{
+				SpawnedTiles.Add(Tile);
+
+				if (bStreamChunks)
+				{
+					Chunks[Pending.ChunkIndex].Tiles.Add(Tile);
+				}
+			}
+		}
+		NumSpawned++;
+
+		if (FPlatformTime::Seconds() - StartTime >= SpawnBudgetSeconds)
+		{
+			break;
+		}
+	}
+
+	if (NumSpawned >= PendingSpawns.Num())
+	{
+		bLevelReady = true;
+		SetActorTickEnabled(false);
+
+		/* Keep leftovers from a larger earlier layout parked for the next round */
+		for (ATile* Tile : ReusableTiles)
+		{
+			Tile->SetActorHiddenInGame(true);
+			Tile->SetActorEnableCollision(false);
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("Arena ready, %d cells placed in %.2f ms."), NumSpawned, (FPlatformTime::Seconds() - GenerationStartTime) * 1000.0);
+		LogLevelActorStats();
+
+		if (Role == ROLE_Authority)
+		{
+			EndNavigationUpdates();
+		}
+
+		if (bStreamChunks)
+		{
+			const AGunslingersGameMode* const Settings = GetDefaultGameMode<AGunslingersGameMode>();
+			const float Interval = Settings ? FMath::Max(0.05f, Settings->StreamingUpdateInterval) : 0.25f;
+
+			GetWorldTimerManager().SetTimer(TimerHandle_ChunkStreaming, this, &AGunslingersGameState::UpdateChunkStreaming, Interval, true);
+			UpdateChunkStreaming();
+		}
+
+		OnLevelReady.Broadcast();
+	}
+}
+
+void AGunslingersGameState::ResetLayout()
+{
+	ReusableTiles.Append(SpawnedTiles);
+	SpawnedTiles.Reset();
+
+	if (TileBatchManager)
+	{
+		TileBatchManager->ClearTileInstances();
+	}
+
+	/* Reused tiles are shown again when they are moved into place */
+	GetWorldTimerManager().ClearTimer(TimerHandle_ChunkStreaming);
+	Chunks.Reset();
+	ChunkIndices.Reset();
+
+	/* A layout still being generated for the old seed is dropped when it finishes */
+	LayoutTask = TFuture<FLevelLayoutPtr>();
+	Layout.Reset();
+	TileGraph.Reset();
+	PendingSpawns.Reset();
+	NumSpawned = 0;
+
+	GetWorldTimerManager().ClearTimer(TimerHandle_NavigationBuild);
+
+	bLevelGenerated = false;
+	bLevelReady = false;
+	bNavigationReady = false;
+
+	/* Clients wait for the checksum of the next layout */
+	if (Role == ROLE_Authority)
+	{
+		LayoutChecksum = 0;
+		LayoutChecksumSeed = 0;
+	}
+}
+
+ATile* AGunslingersGameState::TakeReusableTile(UClass* TileType)
+{
+	for (int32 i = ReusableTiles.Num() - 1; i >= 0; i--)
+	{
+		ATile* Tile = ReusableTiles[i];
+		if (Tile && Tile->GetClass() == TileType)
+		{
+			ReusableTiles.RemoveAtSwap(i);
+			return Tile;
+		}
+	}
+
+	return nullptr;
+}
+
+void AGunslingersGameState::BeginNavigationUpdates()
+{
+	UNavigationSystem* const NavSys = GetWorld()->GetNavigationSystem();
+	if (NavSys && !bNavigationDeferred)
+	{
+		UNavigationSystem::SetNavigationAutoUpdateEnabled(false, NavSys);
+		bNavigationDeferred = true;
+	}
+}
+
+void AGunslingersGameState::EndNavigationUpdates()
+{
+	UNavigationSystem* const NavSys = GetWorld()->GetNavigationSystem();
+	if (NavSys == nullptr)
+	{
+		return;
+	}
+
+	NavigationStartTime = FPlatformTime::Seconds();
+
+	if (bNavigationDeferred)
+	{
+		UNavigationSystem::SetNavigationAutoUpdateEnabled(true, NavSys);
+		bNavigationDeferred = false;
+
+		/* One dirty area over the finished arena, every navmesh tile is built once */
+		FBox ArenaBounds(ForceInit);
+		for (ATile* Tile : SpawnedTiles)
+		{
+			ArenaBounds += Tile->GetComponentsBoundingBox();
+		}
+		if (TileBatchManager)
+		{
+			ArenaBounds += TileBatchManager->GetComponentsBoundingBox(true);
+		}
+
+		if (ArenaBounds.IsValid)
+		{
+			NavSys->AddDirtyArea(ArenaBounds.ExpandBy(TileOffset * 0.5f), ENavigationDirtyFlag::All);
+		}
+	}
+
+	GetWorldTimerManager().SetTimer(TimerHandle_NavigationBuild, this, &AGunslingersGameState::CheckNavigationBuild, 0.1f, true);
+	CheckNavigationBuild();
+}
+
+void AGunslingersGameState::CheckNavigationBuild()
+{
+	UNavigationSystem* const NavSys = GetWorld()->GetNavigationSystem();
+	if (NavSys && NavSys->IsNavigationBuildInProgress())
+	{
+		return;
+	}
+
+	GetWorldTimerManager().ClearTimer(TimerHandle_NavigationBuild);
+	bNavigationReady = true;
+
+	UE_LOG(LogTemp, Log, TEXT("Navigation ready %.2f ms after the arena, %.2f ms after generation started."),
+		(FPlatformTime::Seconds() - NavigationStartTime) * 1000.0, (FPlatformTime::Seconds() - GenerationStartTime) * 1000.0);
+
+	OnNavigationReady.Broadcast();
+}
+
+void AGunslingersGameState::LogLevelActorStats() const
+{
+	int32 NumActors = 0;
+	int32 NumComponents = 0;
+
+	for (TActorIterator<ATile> It(GetWorld()); It; ++It)
+	{
+		NumActors++;
+		NumComponents += It->GetComponents().Num();
+	}
+
+	if (TileBatchManager)
+	{
+		NumActors++;
+		NumComponents += TileBatchManager->GetComponents().Num();
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Arena cost: %d actors, %d components for %d cells (%d batched in %d instanced components)."),
+		NumActors, NumComponents, PendingSpawns.Num(), TileBatchManager ? TileBatchManager->GetNumInstances() : 0, TileBatchManager ? TileBatchManager->GetNumBatches() : 0);
+}
+
+void AGunslingersGameState::QueueLayoutSpawns()
+{
+	/* Merged runs are only drawn by the wall batch, see below */
+	const bool bMergeWalls = TileBatchManager && WallBatchMesh;
+
+	PendingSpawns.Reserve(Layout->TileCells.Num() + (bMergeWalls ? Layout->WallRuns.Num() : Layout->WallCells.Num()));
+
+	for (int32 i = 0; i < Layout->TileCells.Num(); i++) {
+		const FIntPoint& Cell = Layout->TileCells[i];
+		const FRotator Rotation(0.f, 90.f * Layout->TileRotations[i], 0.f);
+		PendingSpawns.Add({ *TileBlueprint, TileBatchMesh, FTransform(Rotation, CellToLocation(Cell)), bStreamChunks ? FindOrAddChunk(Cell) : 0 });
+	}
+
+	/* Wall actors are never stretched, the blueprint's components and UVs are built for one cell */
+	if (!bMergeWalls) {
+		for (const FIntPoint& Cell : Layout->WallCells) {
+			PendingSpawns.Add({ *WallBlueprint, nullptr, FTransform(FRotator::ZeroRotator, CellToLocation(Cell)), bStreamChunks ? FindOrAddChunk(Cell) : 0 });
+		}
+		return;
+	}
+
+	/* One batched wall instance per run, centred on the run and scaled by its length. This assumes
+	   WallBatchMesh is exactly one cell long along X and Y, and that its material tiles in world space
+	   or does not mind being stretched. */
+	for (const FWallRun& Run : Layout->WallRuns) {
+		const FIntPoint Step = Run.bAlongX ? FIntPoint(1, 0) : FIntPoint(0, 1);
+
+		/* A streamed run is cut where it crosses into another chunk */
+		int32 First = 0;
+		while (First < Run.Length) {
+			const int32 ChunkIndex = bStreamChunks ? FindOrAddChunk(Run.Start + Step * First) : 0;
+
+			int32 Last = First;
+			while (bStreamChunks && Last + 1 < Run.Length && FindOrAddChunk(Run.Start + Step * (Last + 1)) == ChunkIndex) {
+				Last++;
+			}
+			if (!bStreamChunks) {
+				Last = Run.Length - 1;
+			}
+
+			const int32 Length = Last - First + 1;
+			const FVector Location = (CellToLocation(Run.Start + Step * First) + CellToLocation(Run.Start + Step * Last)) * 0.5f;
+			const FVector Scale = Run.bAlongX ? FVector(Length, 1.f, 1.f) : FVector(1.f, Length, 1.f);
+			PendingSpawns.Add({ *WallBlueprint, WallBatchMesh, FTransform(FRotator::ZeroRotator, Location, Scale), ChunkIndex });
+
+			First = Last + 1;
+		}
+	}
+}
+
+int32 AGunslingersGameState::FindOrAddChunk(const FIntPoint& Cell)
+{
+	/* Floor division so negative cells do not share chunk 0 with positive ones */
+	const FIntPoint Coord(
+		Cell.X >= 0 ? Cell.X / ChunkSizeInCells : (Cell.X - ChunkSizeInCells + 1) / ChunkSizeInCells,
+		Cell.Y >= 0 ? Cell.Y / ChunkSizeInCells : (Cell.Y - ChunkSizeInCells + 1) / ChunkSizeInCells);
+
+	const int32* ChunkIndex = ChunkIndices.Find(Coord);
+	if (ChunkIndex)
+	{
+		return *ChunkIndex;
+	}
+
+	FArenaChunk Chunk;
+	Chunk.Coord = Coord;
+	Chunk.bVisible = true;
+
+	const int32 NewIndex = Chunks.Add(Chunk);
+	ChunkIndices.Add(Coord, NewIndex);
+	return NewIndex;
+}
+
+void AGunslingersGameState::UpdateChunkStreaming()
+{
+	const float ChunkWidth = ChunkSizeInCells * TileOffset;
+
+	TArray<FIntPoint, TInlineAllocator<4>> ViewerChunks;
+	for (TActorIterator<APlayerController> It(GetWorld()); It; ++It)
+	{
+		const AActor* const ViewTarget = It->IsLocalController() ? It->GetViewTarget() : nullptr;
+		if (ViewTarget)
+		{
+			/* Cells are centred on their location, so shift by half a cell before flooring */
+			const FVector Location = ViewTarget->GetActorLocation() + FVector(TileOffset * 0.5f);
+			ViewerChunks.Add(FIntPoint(FMath::FloorToInt(Location.X / ChunkWidth), FMath::FloorToInt(Location.Y / ChunkWidth)));
+		}
+	}
+
+	/* Nothing to stream around yet, keep whatever is showing */
+	if (ViewerChunks.Num() == 0)
+	{
+		return;
+	}
+
+	int32 NumVisible = 0;
+	int32 NumChanged = 0;
+
+	for (int32 i = 0; i < Chunks.Num(); i++)
+	{
+		bool bInRange = false;
+		for (const FIntPoint& ViewerChunk : ViewerChunks)
+		{
+			const FIntPoint Delta = Chunks[i].Coord - ViewerChunk;
+			if (FMath::Max(FMath::Abs(Delta.X), FMath::Abs(Delta.Y)) <= StreamingRadiusInChunks)
+			{
+				bInRange = true;
+				break;
+			}
+		}
+
+		if (bInRange != Chunks[i].bVisible)
+		{
+			SetChunkVisible(i, bInRange);
+			NumChanged++;
+		}
+		NumVisible += bInRange ? 1 : 0;
+	}
+
+	if (NumChanged > 0)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("Arena streaming: %d of %d chunks visible, %d changed."), NumVisible, Chunks.Num(), NumChanged);
+	}
+}
+
+void AGunslingersGameState::SetChunkVisible(int32 ChunkIndex, bool bVisible)
+{
+	FArenaChunk& Chunk = Chunks[ChunkIndex];
+	Chunk.bVisible = bVisible;
+
+	for (ATile* Tile : Chunk.Tiles)
+	{
+		Tile->SetActorHiddenInGame(!bVisible);
+		Tile->SetActorEnableCollision(bVisible);
+
+		if (TickSignificanceManager == nullptr)
+		{
+			Tile->SetActorTickEnabled(bVisible);
+		}
+	}
+
+	if (TileBatchManager)
+	{
+		TileBatchManager->SetChunkVisible(ChunkIndex, bVisible);
+	}
+}
+
+FIntPoint AGunslingersGameState::LocationToCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::RoundToInt(Location.X / TileOffset), FMath::RoundToInt(Location.Y / TileOffset));
+}
+
+FVector AGunslingersGameState::CellToLocation(const FIntPoint& Cell) const
+{
+	return FVector(Cell.X * TileOffset, Cell.Y * TileOffset, 0.f);
+}
+
+void AGunslingersGameState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AGunslingersGameState, LayoutSeed);
+	DOREPLIFETIME(AGunslingersGameState, LayoutChecksum);
+	DOREPLIFETIME(AGunslingersGameState, LayoutChecksumSeed);
+}
@@ -0,0 +1,257 @@
+// Copyright 1998-2016 Epic Games, Inc. All Rights Reserved.
+#pragma once
+#include "GameFramework/GameStateBase.h"
+#include "World/LevelLayoutGenerator.h"
+#include "World/TileGraph.h"
+#include "GunslingersGameState.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnLevelReadySignature);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnNavigationReadySignature);
+
+/* A tile or wall the level spawn job still has to place */
+struct FPendingTileSpawn
+{
+	UClass* Class;
+	/* Set when the cell is drawn by the batch manager instead of its own actor */
+	UStaticMesh* BatchMesh;
+	/* Merged wall runs are scaled along their length */
+	FTransform Transform;
+	/* Streaming chunk the cell belongs to, 0 when chunks are not streamed */
+	int32 ChunkIndex;
+};
+
+/* Square block of grid cells shown and hidden together on clients */
+struct FArenaChunk
+{
+	FIntPoint Coord;
+	/* Tile actors placed in this chunk, batched cells live in the batch manager */
+	TArray<class ATile*> Tiles;
+	bool bVisible;
+};
+
+/**
+* Owns the arena layout seed. The server picks the seed, it replicates to every client,
+* and each machine runs the same generator locally so no tile actor is ever replicated.
+*/
+UCLASS()
+class AGunslingersGameState : public AGameStateBase
+{
+	GENERATED_BODY()
+
+public:
+	AGunslingersGameState();
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	/* Server only: set the seed every machine builds the arena from. Changing it after the arena
+	   was built lays it out again, moving the existing tile actors instead of respawning them. */
+	void SetLayoutSeed(int32 NewSeed);
+
+	int32 GetLayoutSeed() const;
+
+	/* Checksum of the layout generated on this machine, 0 until generated */
+	uint32 GetLocalLayoutChecksum() const;
+
+	/* Arena layout generated on this machine, in grid cells */
+	const FLevelLayout& GetLayout() const;
+
+	/* Tile adjacency of the current arena with its shared route cache, built on the server for the guards */
+	const FTileGraph& GetTileGraph() const;
+
+	FIntPoint LocationToCell(const FVector& Location) const;
+	FVector CellToLocation(const FIntPoint& Cell) const;
+
+	/* True once every tile and wall of the arena has been spawned on this machine */
+	UFUNCTION(BlueprintCallable, Category = "Level")
+	bool IsLevelReady() const;
+
+	/* Fraction of the arena spawned so far, for loading screens and the HUD */
+	UFUNCTION(BlueprintCallable, Category = "Level")
+	float GetLevelProgress() const;
+
+	/* Controls tile, weapon and character ticks when the game mode asks for it, may be null */
+	class ATickSignificanceManager* GetTickSignificanceManager() const;
+
+	/* Batches weapon traces when the game mode asks for it, may be null */
+	class AWeaponTraceManager* GetWeaponTraceManager() const;
+
+	/* Refires automatic weapons when the game mode asks for it, may be null */
+	class AWeaponFireScheduler* GetWeaponFireScheduler() const;
+
+	/* Recycles weapon effects when the game mode asks for it, null on dedicated servers */
+	class AWeaponEffectsPool* GetWeaponEffectsPool() const;
+
+	/* Holds prewarmed projectiles when the game mode asks for it, may be null */
+	class AGunslingersProjectilePool* GetProjectilePool() const;
+
+	/* Collects pawn noises for the guards when the game mode asks for it, server only */
+	class ANoiseFieldManager* GetNoiseFieldManager() const;
+
+	/* Fires on each machine whenever the arena is fully spawned, including after a new layout */
+	UPROPERTY(BlueprintAssignable, Category = "Level")
+	FOnLevelReadySignature OnLevelReady;
+
+	/* True once the navmesh covers the current arena. Only the server builds navigation. */
+	UFUNCTION(BlueprintCallable, Category = "Level")
+	bool IsNavigationReady() const;
+
+	/* Fires on the server when the navmesh for the current arena is built, guards can start moving */
+	UPROPERTY(BlueprintAssignable, Category = "Level")
+	FOnNavigationReadySignature OnNavigationReady;
+
+protected:
+
+	void GenerateLevel();
+
+	/* Game thread side of generation: take the finished layout and queue its spawns */
+	void ConsumeLayout(const FLevelLayoutPtr& NewLayout);
+
+	/* Queue a spawn for every tile and wall of Layout, no actors are spawned here */
+	void QueueLayoutSpawns();
+
+	/* Spawn queued tiles until the frame budget runs out */
+	void SpawnPendingTiles();
+
+	/* Forget the current layout and keep its tile actors around for the next one */
+	void ResetLayout();
+
+	/* Reuse a hidden tile actor of TileType if one is left over from an earlier layout */
+	class ATile* TakeReusableTile(UClass* TileType);
+
+	/* Stop the navmesh from following tiles as they spawn */
+	void BeginNavigationUpdates();
+
+	/* Mark the whole arena dirty once and wait for the navmesh build */
+	void EndNavigationUpdates();
+
+	/* Polled until the navmesh build finishes */
+	void CheckNavigationBuild();
+
+	/* Log how many actors and components the arena costs on this machine */
+	void LogLevelActorStats() const;
+
+	/* Chunk index for a cell, adding the chunk the first time one of its cells is seen */
+	int32 FindOrAddChunk(const FIntPoint& Cell);
+
+	/* Show the chunks near local players and hide the rest, client only */
+	void UpdateChunkStreaming();
+
+	void SetChunkVisible(int32 ChunkIndex, bool bVisible);
+
+private:
+
+	UPROPERTY(Transient, ReplicatedUsing = OnRep_LayoutSeed)
+	int32 LayoutSeed;
+
+	/* Checksum of the server's layout, clients compare their own result against it */
+	UPROPERTY(Transient, ReplicatedUsing = OnRep_LayoutChecksum)
+	uint32 LayoutChecksum;
+
+	/* Seed LayoutChecksum was generated from, replicated with it so a client never compares its
+	   new layout against the checksum of the previous one */
+	UPROPERTY(Transient, Replicated)
+	int32 LayoutChecksumSeed;
+
+	UFUNCTION()
+	void OnRep_LayoutSeed();
+
+	UFUNCTION()
+	void OnRep_LayoutChecksum();
+
+	/* Determinism check, logs an error when the client layout differs from the server */
+	void VerifyLayoutChecksum();
+
+	/* Arena generated on this machine, null until the generation task finishes */
+	FLevelLayoutPtr Layout;
+
+	/* Layout being generated on a worker thread */
+	TFuture<FLevelLayoutPtr> LayoutTask;
+
+	FTileGraph TileGraph;
+
+	bool bLevelGenerated;
+
+	bool bLevelReady;
+
+	bool bNavigationReady;
+
+	/* Navmesh auto update is off until the arena is spawned */
+	bool bNavigationDeferred;
+
+	double NavigationStartTime;
+
+	FTimerHandle TimerHandle_NavigationBuild;
+
+	/* Layout output waiting to be spawned, consumed front to back */
+	TArray<FPendingTileSpawn> PendingSpawns;
+
+	int32 NumSpawned;
+
+	double SpawnBudgetSeconds;
+
+	double GenerationStartTime;
+
+	/* Owns the instanced floor and wall components when tiles are batched */
+	UPROPERTY(Transient)
+	class ATileBatchManager* TileBatchManager;
+
+	UPROPERTY(Transient)
+	class ATickSignificanceManager* TickSignificanceManager;
+
+	UPROPERTY(Transient)
+	class AWeaponTraceManager* WeaponTraceManager;
+
+	UPROPERTY(Transient)
+	class AWeaponFireScheduler* WeaponFireScheduler;
+
+	UPROPERTY(Transient)
+	class AWeaponEffectsPool* WeaponEffectsPool;
+
+	UPROPERTY(Transient)
+	class AGunslingersProjectilePool* ProjectilePool;
+
+	UPROPERTY(Transient)
+	class ANoiseFieldManager* NoiseFieldManager;
+
+	/* Tile actors placed for the current layout */
+	UPROPERTY(Transient)
+	TArray<class ATile*> SpawnedTiles;
+
+	/* Hidden tile actors from earlier layouts, waiting to be moved into place */
+	UPROPERTY(Transient)
+	TArray<class ATile*> ReusableTiles;
+
+	UPROPERTY(Transient)
+	UStaticMesh* TileBatchMesh;
+
+	UPROPERTY(Transient)
+	UStaticMesh* WallBatchMesh;
+
+	UPROPERTY(Transient)
+	TSubclassOf<class ATile> TileBlueprint;
+
+	UPROPERTY(Transient)
+	TSubclassOf<class ATile> WallBlueprint;
+
+	float TileOffset;
+
+	int32 NumberOfTiles;
+
+	/* Set on clients when the game mode streams arena chunks */
+	bool bStreamChunks;
+
+	int32 ChunkSizeInCells;
+
+	int32 StreamingRadiusInChunks;
+
+	/* Chunks of the current layout. Tile pointers are also held by SpawnedTiles. */
+	TArray<FArenaChunk> Chunks;
+
+	TMap<FIntPoint, int32> ChunkIndices;
+
+	FTimerHandle TimerHandle_ChunkStreaming;
+};
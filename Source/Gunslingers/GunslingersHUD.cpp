@@ -2,6 +2,8 @@
 
 #include "Gunslingers.h"
 #include "GunslingersHUD.h"
+#include "GunslingersGameState.h"
+#include "Engine/Engine.h"
 #include "Engine/Canvas.h"
 #include "TextureResource.h"
 #include "CanvasItem.h"
@@ -31,5 +33,13 @@ void AGunslingersHUD::DrawHUD()
 	FCanvasTileItem TileItem( CrosshairDrawPosition, CrosshairTex->Resource, FLinearColor::White);
 	TileItem.BlendMode = SE_BLEND_Translucent;
 	Canvas->DrawItem( TileItem );
+
+	// show arena build progress until the level is ready
+	const AGunslingersGameState* GS = GetWorld()->GetGameState<AGunslingersGameState>();
+	if (GS && !GS->IsLevelReady())
+	{
+		const FString ProgressText = FString::Printf(TEXT("Building arena %d%%"), FMath::RoundToInt(GS->GetLevelProgress() * 100.f));
+		Canvas->DrawText(GEngine->GetMediumFont(), ProgressText, Center.X - 80.0f, Center.Y - 60.0f);
+	}
 }
 
@@ -3,6 +3,7 @@
 #include "Gunslingers.h"
 #include "GunslingersProjectile.h"
 #include "GameFramework/ProjectileMovementComponent.h"
+#include "GunslingersProjectilePool.h"
 
 AGunslingersProjectile::AGunslingersProjectile() 
 {
@@ -29,6 +30,10 @@ AGunslingersProjectile::AGunslingersProjectile()
 
 	// Die after 3 seconds by default
 	InitialLifeSpan = 3.0f;
+	PooledLifeSpan = 3.0f;
+
+	Pool = nullptr;
+	bActive = true;
 }
 
 void AGunslingersProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
@@ -38,6 +43,58 @@ void AGunslingersProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherAc
 	{
 		OtherComp->AddImpulseAtLocation(GetVelocity() * 100.0f, GetActorLocation());
 
+		Release();
+	}
+}
+
+void AGunslingersProjectile::Launch(const FVector& Location, const FRotator& Rotation)
+{
+	bActive = true;
+
+	SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+
+	/* Movement stops simulating and lets go of the collision once the projectile comes to rest */
+	ProjectileMovement->SetUpdatedComponent(CollisionComp);
+	ProjectileMovement->Velocity = Rotation.Vector() * ProjectileMovement->InitialSpeed;
+	ProjectileMovement->UpdateComponentVelocity();
+	ProjectileMovement->Activate(true);
+
+	GetWorldTimerManager().SetTimer(TimerHandle_Release, this, &AGunslingersProjectile::Release, PooledLifeSpan, false);
+}
+
+void AGunslingersProjectile::Deactivate()
+{
+	bActive = false;
+
+	GetWorldTimerManager().ClearTimer(TimerHandle_Release);
+
+	ProjectileMovement->StopMovementImmediately();
+	ProjectileMovement->Deactivate();
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+}
+
+void AGunslingersProjectile::Release()
+{
+	if (Pool)
+	{
+		Pool->ReturnProjectile(this);
+	}
+	else
+	{
 		Destroy();
 	}
+}
+
+void AGunslingersProjectile::SetPool(AGunslingersProjectilePool* NewPool)
+{
+	Pool = NewPool;
+}
+
+bool AGunslingersProjectile::IsActive() const
+{
+	return bActive;
 }
\ No newline at end of file
@@ -23,6 +23,34 @@ public:
 	UFUNCTION()
 	void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
+	/* Seconds a pooled projectile flies before going back to the pool, spawned ones use InitialLifeSpan */
+	UPROPERTY(EditDefaultsOnly, Category = Projectile)
+	float PooledLifeSpan;
+
+	/* Pooled projectiles: move to Location and fly off at InitialSpeed, with fresh movement and collision */
+	void Launch(const FVector& Location, const FRotator& Rotation);
+
+	/* Hide and stop, ready for the next Launch */
+	void Deactivate();
+
+	/* Back to the pool it came from, or destroyed when it was spawned on its own */
+	void Release();
+
+	void SetPool(class AGunslingersProjectilePool* NewPool);
+
+	bool IsActive() const;
+
+private:
+
+	UPROPERTY(Transient)
+	class AGunslingersProjectilePool* Pool;
+
+	FTimerHandle TimerHandle_Release;
+
+	bool bActive;
+
+public:
+
 	/** Returns CollisionComp subobject **/
 	FORCEINLINE class USphereComponent* GetCollisionComp() const { return CollisionComp; }
 	/** Returns ProjectileMovement subobject **/
@@ -0,0 +1,158 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Gunslingers.h"
+#include "GunslingersProjectilePool.h"
+#include "GunslingersProjectile.h"
+#include "GunslingersGameMode.h"
+#include "GunslingersGameState.h"
+
+DECLARE_STATS_GROUP(TEXT("ProjectilePool"), STATGROUP_ProjectilePool, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Launch Projectile"), STAT_LaunchProjectile, STATGROUP_ProjectilePool);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Projectiles"), STAT_PooledProjectiles, STATGROUP_ProjectilePool);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectiles In Flight"), STAT_ProjectilesInFlight, STATGROUP_ProjectilePool);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectiles Recycled In Flight"), STAT_ProjectilesRecycled, STATGROUP_ProjectilePool);
+
+
+AGunslingersProjectilePool::AGunslingersProjectilePool()
+{
+	ProjectileClass = AGunslingersProjectile::StaticClass();
+	NumPrewarmed = 32;
+	MaxProjectiles = 128;
+}
+
+void AGunslingersProjectilePool::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const AGunslingersGameMode* const Settings = GetWorld()->GetGameState() ? GetWorld()->GetGameState()->GetDefaultGameMode<AGunslingersGameMode>() : nullptr;
+	if (Settings)
+	{
+		if (Settings->PooledProjectileClass)
+		{
+			ProjectileClass = Settings->PooledProjectileClass;
+		}
+		MaxProjectiles = FMath::Max(1, Settings->MaxPooledProjectiles);
+		NumPrewarmed = FMath::Clamp(Settings->NumPrewarmedProjectiles, 0, MaxProjectiles);
+	}
+
+	FreeProjectiles.Reserve(MaxProjectiles);
+	ActiveProjectiles.Reserve(MaxProjectiles);
+
+	for (int32 i = 0; i < NumPrewarmed; i++)
+	{
+		AGunslingersProjectile* const Projectile = AddProjectile();
+		if (Projectile)
+		{
+			FreeProjectiles.Add(Projectile);
+		}
+	}
+}
+
+AGunslingersProjectilePool* AGunslingersProjectilePool::Get(const UObject* WorldContextObject)
+{
+	const UWorld* const World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	const AGunslingersGameState* const GS = World ? World->GetGameState<AGunslingersGameState>() : nullptr;
+
+	return GS ? GS->GetProjectilePool() : nullptr;
+}
+
+AGunslingersProjectile* AGunslingersProjectilePool::SpawnProjectile(const UObject* WorldContextObject, TSubclassOf<AGunslingersProjectile> Class, const FVector& Location, const FRotator& Rotation, AActor* ProjectileOwner, APawn* ProjectileInstigator)
+{
+	AGunslingersProjectilePool* const ProjectilePool = Get(WorldContextObject);
+	if (ProjectilePool && Class == ProjectilePool->GetProjectileClass())
+	{
+		return ProjectilePool->LaunchProjectile(Location, Rotation, ProjectileOwner, ProjectileInstigator);
+	}
+
+	UWorld* const World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	if (World == nullptr || Class == nullptr)
+	{
+		return nullptr;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Owner = ProjectileOwner;
+	SpawnParams.Instigator = ProjectileInstigator;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return World->SpawnActor<AGunslingersProjectile>(Class, Location, Rotation, SpawnParams);
+}
+
+AGunslingersProjectile* AGunslingersProjectilePool::LaunchProjectile(const FVector& Location, const FRotator& Rotation, AActor* ProjectileOwner, APawn* ProjectileInstigator)
+{
+	SCOPE_CYCLE_COUNTER(STAT_LaunchProjectile);
+
+	AGunslingersProjectile* Projectile = nullptr;
+	if (FreeProjectiles.Num() > 0)
+	{
+		Projectile = FreeProjectiles.Pop(false);
+	}
+	else if (ActiveProjectiles.Num() + FreeProjectiles.Num() < MaxProjectiles)
+	{
+		Projectile = AddProjectile();
+	}
+	else if (ActiveProjectiles.Num() > 0)
+	{
+		Projectile = ActiveProjectiles[0];
+		ActiveProjectiles.RemoveAt(0, 1, false);
+		INC_DWORD_STAT(STAT_ProjectilesRecycled);
+	}
+
+	if (Projectile == nullptr)
+	{
+		return nullptr;
+	}
+
+	Projectile->SetOwner(ProjectileOwner);
+	Projectile->Instigator = ProjectileInstigator;
+	Projectile->Launch(Location, Rotation);
+
+	ActiveProjectiles.Add(Projectile);
+	SET_DWORD_STAT(STAT_ProjectilesInFlight, ActiveProjectiles.Num());
+
+	return Projectile;
+}
+
+void AGunslingersProjectilePool::ReturnProjectile(AGunslingersProjectile* Projectile)
+{
+	if (Projectile && Projectile->IsActive())
+	{
+		Projectile->Deactivate();
+		ActiveProjectiles.RemoveSingle(Projectile);
+		FreeProjectiles.Add(Projectile);
+		SET_DWORD_STAT(STAT_ProjectilesInFlight, ActiveProjectiles.Num());
+	}
+}
+
+TSubclassOf<AGunslingersProjectile> AGunslingersProjectilePool::GetProjectileClass() const
+{
+	return ProjectileClass;
+}
+
+void AGunslingersProjectilePool::SetMaxProjectiles(int32 NewMaxProjectiles)
+{
+	MaxProjectiles = FMath::Max(1, NewMaxProjectiles);
+}
+
+int32 AGunslingersProjectilePool::GetNumProjectiles() const
+{
+	return FreeProjectiles.Num() + ActiveProjectiles.Num();
+}
+
+AGunslingersProjectile* AGunslingersProjectilePool::AddProjectile()
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Owner = this;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	AGunslingersProjectile* const Projectile = GetWorld()->SpawnActor<AGunslingersProjectile>(ProjectileClass, GetActorLocation(), FRotator::ZeroRotator, SpawnParams);
+	if (Projectile)
+	{
+		/* The pool decides when a projectile is done, not the actor life span */
+		Projectile->SetLifeSpan(0.f);
+		Projectile->SetPool(this);
+		Projectile->Deactivate();
+		INC_DWORD_STAT(STAT_PooledProjectiles);
+	}
+
+	return Projectile;
+}
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "GunslingersProjectilePool.generated.h"
+
+class AGunslingersProjectile;
+
+/**
+* Keeps projectiles of one class alive between shots. A prewarmed set is spawned once and hidden,
+* launching a projectile moves one into place and returning it on hit or after its life span
+* hides it again, so firing creates no actors, components or physics bodies.
+*/
+UCLASS()
+class GUNSLINGERS_API AGunslingersProjectilePool : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AGunslingersProjectilePool();
+
+	/* Spawns the prewarmed projectiles */
+	virtual void BeginPlay() override;
+
+	/* Pool of the world WorldContextObject is in, null when projectiles are not pooled */
+	static AGunslingersProjectilePool* Get(const UObject* WorldContextObject);
+
+	/* Launch a projectile of Class from the pool when it holds that class, spawn one otherwise.
+	   Weapons that fire projectiles, native or Blueprint, should call this instead of SpawnActor. */
+	UFUNCTION(BlueprintCallable, Category = "Projectile", meta = (WorldContext = "WorldContextObject"))
+	static AGunslingersProjectile* SpawnProjectile(const UObject* WorldContextObject, TSubclassOf<AGunslingersProjectile> Class, const FVector& Location, const FRotator& Rotation, AActor* ProjectileOwner, APawn* ProjectileInstigator);
+
+	/* A free projectile, a new one while below the cap, else the oldest one in flight */
+	AGunslingersProjectile* LaunchProjectile(const FVector& Location, const FRotator& Rotation, AActor* ProjectileOwner, APawn* ProjectileInstigator);
+
+	void ReturnProjectile(AGunslingersProjectile* Projectile);
+
+	TSubclassOf<AGunslingersProjectile> GetProjectileClass() const;
+
+	/* Launches past this many projectiles relaunch the oldest one in flight */
+	void SetMaxProjectiles(int32 NewMaxProjectiles);
+
+	/* Projectiles spawned so far, stays flat once the pool is warm */
+	UFUNCTION(BlueprintCallable, Category = "Performance")
+	int32 GetNumProjectiles() const;
+
+private:
+
+	AGunslingersProjectile* AddProjectile();
+
+	TSubclassOf<AGunslingersProjectile> ProjectileClass;
+
+	int32 NumPrewarmed;
+
+	int32 MaxProjectiles;
+
+	UPROPERTY(Transient)
+	TArray<AGunslingersProjectile*> FreeProjectiles;
+
+	/* In launch order, the first one is the oldest */
+	UPROPERTY(Transient)
+	TArray<AGunslingersProjectile*> ActiveProjectiles;
+};
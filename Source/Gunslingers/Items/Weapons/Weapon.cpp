@@ -3,6 +3,15 @@
 #include "Gunslingers.h"
 #include "Weapon.h"
 #include "../../Characters/PlayerCharacter.h"
+#include "../../World/TickSignificanceManager.h"
+#include "WeaponFireScheduler.h"
+#include "WeaponEffectsPool.h"
+#include "GunslingersGameMode.h"
+
+static_assert((uint8)EWeaponState::Idle == (uint8)FWeaponStateMachine::EState::Idle
+	&& (uint8)EWeaponState::Firing == (uint8)FWeaponStateMachine::EState::Firing
+	&& (uint8)EWeaponState::Equipping == (uint8)FWeaponStateMachine::EState::Equipping
+	&& (uint8)EWeaponState::Reloading == (uint8)FWeaponStateMachine::EState::Reloading, "EWeaponState must match FWeaponStateMachine::EState");
 
 AWeapon::AWeapon(const class FObjectInitializer& PCIP)
 	: Super(PCIP)
@@ -20,22 +29,91 @@ AWeapon::AWeapon(const class FObjectInitializer& PCIP)
 	bIsEquipped = false;
 	CurrentState = EWeaponState::Idle;
 
+	CurrentShotTime = 0.f;
+	NextShotSequence = 1;
+	LastAppliedShot = 0;
+	LastAppliedShotTime = -BIG_NUMBER;
+	ShotAllowance = ShotRedundancy;
+	ShotAllowanceTime = 0.f;
+	NumDuplicateShots = 0;
+	NumRefusedShots = 0;
+	NumSkippedShots = 0;
+	ShotSeedSalt = 0;
+	PredictedReloadCount = 0;
+
 	PrimaryActorTick.bCanEverTick = true;
 	PrimaryActorTick.TickGroup = TG_PrePhysics;
 
 	SetReplicates(true);
 	bNetUseOwnerRelevancy = true;
 
-	MuzzleAttachPoint = TEXT("MuzzleFlashSocket");
-	StorageSlot = EInventorySlot::Rifle;
 
-	ShotsPerMinute = 700;
-	StartAmmo = 999;
-	MaxAmmo = 999;
-	MaxAmmoPerClip = 30;
-	NoAnimReloadDuration = 1.5f;
-	NoEquipAnimDuration = 0.5f;
+	Definition = nullptr;
+
+#if WITH_EDITORONLY_DATA
+	/* The old per weapon defaults, what blueprints that never changed a value migrate */
+	StorageSlot_DEPRECATED = EInventorySlot::Rifle;
+	ShotsPerMinute_DEPRECATED = 700;
+	StartAmmo_DEPRECATED = 999;
+	MaxAmmo_DEPRECATED = 999;
+	MaxAmmoPerClip_DEPRECATED = 30;
+	FireSound_DEPRECATED = nullptr;
+	EquipSound_DEPRECATED = nullptr;
+	OutOfAmmoSound_DEPRECATED = nullptr;
+	ReloadSound_DEPRECATED = nullptr;
+	EquipAnim_DEPRECATED = nullptr;
+	FireAnim_DEPRECATED = nullptr;
+	ReloadAnim_DEPRECATED = nullptr;
+	NoAnimReloadDuration_DEPRECATED = 1.5f;
+	NoEquipAnimDuration_DEPRECATED = 0.5f;
+	MuzzleFX_DEPRECATED = nullptr;
+	MuzzleAttachPoint_DEPRECATED = TEXT("MuzzleFlashSocket");
+#endif
+}
+
+
+void AWeapon::PostLoad()
+{
+	Super::PostLoad();
+
+#if WITH_EDITORONLY_DATA
+	/* Blueprints saved before definitions existed get one holding their old values, stored in
+	   their own package so weapons spawned from them share it and it is saved with them */
+	if (Definition == nullptr)
+	{
+		UPackage* const Package = GetOutermost();
+		const FName DefinitionName = MakeUniqueObjectName(Package, UWeaponDefinition::StaticClass(), *FString::Printf(TEXT("%s_Definition"), *GetClass()->GetName()));
+
+		UWeaponDefinition* const NewDefinition = NewObject<UWeaponDefinition>(Package, DefinitionName);
+		MigrateDeprecatedTuning(NewDefinition);
+		NewDefinition->UpdateStats();
+		Definition = NewDefinition;
+	}
+#endif
+}
+
+
+#if WITH_EDITORONLY_DATA
+void AWeapon::MigrateDeprecatedTuning(UWeaponDefinition* NewDefinition) const
+{
+	NewDefinition->StorageSlot = StorageSlot_DEPRECATED;
+	NewDefinition->ShotsPerMinute = ShotsPerMinute_DEPRECATED;
+	NewDefinition->StartAmmo = StartAmmo_DEPRECATED;
+	NewDefinition->MaxAmmo = MaxAmmo_DEPRECATED;
+	NewDefinition->MaxAmmoPerClip = MaxAmmoPerClip_DEPRECATED;
+	NewDefinition->FireSound = FireSound_DEPRECATED;
+	NewDefinition->EquipSound = EquipSound_DEPRECATED;
+	NewDefinition->OutOfAmmoSound = OutOfAmmoSound_DEPRECATED;
+	NewDefinition->ReloadSound = ReloadSound_DEPRECATED;
+	NewDefinition->EquipAnim = EquipAnim_DEPRECATED;
+	NewDefinition->FireAnim = FireAnim_DEPRECATED;
+	NewDefinition->ReloadAnim = ReloadAnim_DEPRECATED;
+	NewDefinition->NoAnimReloadDuration = NoAnimReloadDuration_DEPRECATED;
+	NewDefinition->NoEquipAnimDuration = NoEquipAnimDuration_DEPRECATED;
+	NewDefinition->MuzzleFX = MuzzleFX_DEPRECATED;
+	NewDefinition->MuzzleAttachPoint = MuzzleAttachPoint_DEPRECATED;
 }
+#endif
 
 
 void AWeapon::PostInitializeComponents()
@@ -43,9 +121,26 @@ void AWeapon::PostInitializeComponents()
 	Super::PostInitializeComponents();
 
 	/* Setup configuration */
-	TimeBetweenShots = 60.0f / ShotsPerMinute;
-	CurrentAmmo = FMath::Min(StartAmmo, MaxAmmo);
-	CurrentAmmoInClip = FMath::Min(MaxAmmoPerClip, StartAmmo);
+	if (Definition == nullptr)
+	{
+		Definition = GetMutableDefault<UWeaponDefinition>();
+	}
+
+	AmmoState.Ammo = GetStats().StartAmmo;
+	AmmoState.AmmoInClip = GetStats().StartAmmoInClip;
+}
+
+
+void AWeapon::BeginPlay()
+{
+	Super::BeginPlay();
+
+	/* No native tick, only blueprints with Event Tick keep ticking */
+	ATickSignificanceManager* const SignificanceManager = ATickSignificanceManager::Get(this);
+	if (SignificanceManager)
+	{
+		SignificanceManager->RegisterActor(this, false, true);
+	}
 }
 
 
@@ -53,6 +148,20 @@ void AWeapon::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
+	AWeaponFireScheduler* const Scheduler = AWeaponFireScheduler::Get(this);
+	if (Scheduler)
+	{
+		Scheduler->StopFiring(this);
+	}
+
+	/* A pooled flash outlives the weapon, give it back */
+	if (MuzzlePSC && MuzzlePSC->GetOwner() != this && MuzzlePSC->GetAttachParent() == Mesh)
+	{
+		MuzzlePSC->DeactivateSystem();
+		MuzzlePSC->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+	}
+	MuzzlePSC = nullptr;
+
 	DetachMeshFromPawn();
 	StopSimulatingWeaponFire();
 }
@@ -81,6 +190,20 @@ void AWeapon::SetOwningPawn(APlayerCharacter* NewOwner)
 		MyPawn = NewOwner;
 		// Net owner for RPC calls.
 		SetOwner(NewOwner);
+
+		/* A new owner starts its own shot stream */
+		RecentShots.Reset();
+		NextShotSequence = 1;
+		LastAppliedShot = 0;
+		LastAppliedShotTime = -BIG_NUMBER;
+		ShotAllowance = ShotRedundancy;
+		AmmoState.ShotSequence = 0;
+		PredictedEvents.Reset();
+
+		if (Role == ROLE_Authority)
+		{
+			ShotSeedSalt = FMath::Rand();
+		}
 	}
 }
 
@@ -128,11 +251,11 @@ void AWeapon::OnEquipWeapon(bool bPlayAnimation)
 
 	if (bPlayAnimation)
 	{
-		float Duration = PlayWeaponAnimation(EquipAnim);
+		float Duration = PlayWeaponAnimation(Definition->EquipAnim);
 		if (Duration <= 0.0f)
 		{
 			// Failsafe in case animation is missing
-			Duration = NoEquipAnimDuration;
+			Duration = Definition->NoEquipAnimDuration;
 		}
 		EquipStartedTime = GetWorld()->TimeSeconds;
 		EquipDuration = Duration;
@@ -147,7 +270,7 @@ void AWeapon::OnEquipWeapon(bool bPlayAnimation)
 
 	if (MyPawn && MyPawn->IsLocallyControlled())
 	{
-		PlayWeaponSound(EquipSound);
+		PlayWeaponSound(Definition->EquipSound);
 	}
 }
 
@@ -159,15 +282,15 @@ void AWeapon::OnUnEquip()
 
 	if (bPendingEquip)
 	{
-		StopWeaponAnimation(EquipAnim);
+		StopWeaponAnimation(Definition->EquipAnim);
 		bPendingEquip = false;
 
 		GetWorldTimerManager().ClearTimer(EquipFinishedTimerHandle);
 	}
-	if (bPendingReload)
+	if (FireState.bPendingReload)
 	{
-		StopWeaponAnimation(ReloadAnim);
-		bPendingReload = false;
+		StopWeaponAnimation(Definition->ReloadAnim);
+		FireState.bPendingReload = false;
 
 		GetWorldTimerManager().ClearTimer(TimerHandle_ReloadWeapon);
 	}
@@ -179,7 +302,7 @@ void AWeapon::OnUnEquip()
 void AWeapon::OnEnterInventory(APlayerCharacter* NewOwner)
 {
 	SetOwningPawn(NewOwner);
-	AttachMeshToPawn(StorageSlot);
+	AttachMeshToPawn(Definition->StorageSlot);
 }
 
 
@@ -230,7 +353,8 @@ void AWeapon::StopFire()
 {
 	if (Role < ROLE_Authority)
 	{
-		ServerStopFire();
+		ServerStopFire(RecentShots);
+		RecentShots.Reset();
 	}
 
 	if (bWantsToFire)
@@ -253,23 +377,222 @@ void AWeapon::ServerStartFire_Implementation()
 }
 
 
-bool AWeapon::ServerStopFire_Validate()
+bool AWeapon::ServerStopFire_Validate(const TArray<FWeaponShot>& LastShots)
 {
-	return true;
+	return LastShots.Num() <= ShotRedundancy && AreConsecutiveShots(LastShots);
 }
 
 
-void AWeapon::ServerStopFire_Implementation()
+void AWeapon::ServerStopFire_Implementation(const TArray<FWeaponShot>& LastShots)
 {
+	ApplyShots(LastShots);
 	StopFire();
+
+	UE_LOG(LogTemp, Verbose, TEXT("%s: burst ended at shot %d, %d repeated and %d refused shots dropped so far."), *GetName(), LastAppliedShot, NumDuplicateShots, NumRefusedShots);
+}
+
+
+bool AWeapon::ServerFireShots_Validate(const TArray<FWeaponShot>& Shots)
+{
+	return Shots.Num() <= ShotRedundancy && AreConsecutiveShots(Shots);
+}
+
+
+void AWeapon::ServerFireShots_Implementation(const TArray<FWeaponShot>& Shots)
+{
+	ApplyShots(Shots);
+}
+
+
+FWeaponShot AWeapon::MakeLocalShot()
+{
+	FWeaponShot Shot;
+	Shot.Sequence = NextShotSequence++;
+	Shot.Time = GetShotServerTime();
+	Shot.Aim = GetAdjustedAim();
+	Shot.Origin = GetCameraDamageStartLocation(Shot.Aim);
+	Shot.Quantize();
+
+	return Shot;
+}
+
+
+void AWeapon::SendShot(const FWeaponShot& Shot, bool bUsedAmmo)
+{
+	if (RecentShots.Num() >= ShotRedundancy)
+	{
+		RecentShots.RemoveAt(0, 1, false);
+	}
+	RecentShots.Add(Shot);
+
+	FPredictedWeaponEvent Event;
+	Event.ShotSequence = Shot.Sequence;
+	Event.ReloadCount = PredictedReloadCount;
+	Event.bReload = false;
+	Event.bUsedAmmo = bUsedAmmo;
+	Event.Time = GetWorld()->GetTimeSeconds();
+	PredictedEvents.Add(Event);
+
+	ServerFireShots(RecentShots);
+}
+
+
+void AWeapon::ApplyShots(const TArray<FWeaponShot>& Shots)
+{
+	const AGunslingersGameMode* const GM = GetWorld()->GetAuthGameMode<AGunslingersGameMode>();
+	const float Now = GetWorld()->GetTimeSeconds();
+	const float OldestShotTime = GM ? Now - GM->MaxRewindSeconds : -BIG_NUMBER;
+
+	/* Shots arrive oldest first, anything not newer than the last applied one is a repeat */
+	for (const FWeaponShot& Shot : Shots)
+	{
+		if (!IsNewerShot(Shot.Sequence, LastAppliedShot))
+		{
+			NumDuplicateShots++;
+			continue;
+		}
+
+		/* A skipped sequence was fired and lost, or skipped to pick a spread pattern. Either way it
+		   costs its round, which also matches what the owner predicted for lost shots. */
+		const int32 NumSkipped = FMath::Min((int32)(int16)(Shot.Sequence - LastAppliedShot) - 1, GetStats().MaxAmmoPerClip);
+		for (int32 i = 0; i < NumSkipped && AmmoState.AmmoInClip > 0; i++)
+		{
+			UseAmmo();
+		}
+		NumSkippedShots += FMath::Max(0, NumSkipped);
+
+		LastAppliedShot = Shot.Sequence;
+		AmmoState.ShotSequence = Shot.Sequence;
+
+		/* Every packet repeats the last ShotRedundancy shots and the burst's end is reliable, a longer
+		   gap is lost to heavy loss at best, the shot after it is not trusted with its pattern */
+		if (NumSkipped > ShotRedundancy)
+		{
+			NumRefusedShots++;
+			continue;
+		}
+
+		/* Shot times only go forward and are never older than a hit can be rewound */
+		if (Shot.Time < LastAppliedShotTime || Shot.Time < OldestShotTime)
+		{
+			NumRefusedShots++;
+			continue;
+		}
+
+		/* Refuse shots stamped faster than the weapon can fire, clock jitter gets half a shot of slack,
+		   and shots arriving faster than it can fire by the server's own clock */
+		if (Shot.Time - LastAppliedShotTime < GetStats().TimeBetweenShots * 0.5f || !ConsumeShotAllowance())
+		{
+			NumRefusedShots++;
+			continue;
+		}
+
+		LastAppliedShotTime = Shot.Time;
+
+		/* On the server its own time is the server time, a shot cannot come from the future */
+		FWeaponShot AppliedShot = Shot;
+		AppliedShot.Time = FMath::Min(Shot.Time, Now);
+
+		/* The client picks where its traces start, a shot starting away from its pawn or behind a wall is dropped */
+		if (!IsValidShotOrigin(AppliedShot.Origin))
+		{
+			NumRefusedShots++;
+			continue;
+		}
+
+		ApplyShot(AppliedShot);
+	}
+}
+
+
+bool AWeapon::IsValidShotOrigin(const FVector& Origin) const
+{
+	if (MyPawn == nullptr)
+	{
+		return false;
+	}
+
+	/* GetCameraDamageStartLocation moves the eyes along the aim to the pawn's depth, never further than its capsule */
+	float Radius = 0.f;
+	float HalfHeight = 0.f;
+	MyPawn->GetSimpleCollisionCylinder(Radius, HalfHeight);
+
+	const FVector ViewLocation = MyPawn->GetPawnViewLocation();
+	if (FVector::DistSquared(Origin, ViewLocation) > FMath::Square(Radius + HalfHeight))
+	{
+		return false;
+	}
+
+	return !WeaponTrace(ViewLocation, Origin, true).bBlockingHit;
+}
+
+
+bool AWeapon::AreConsecutiveShots(const TArray<FWeaponShot>& Shots)
+{
+	for (int32 i = 1; i < Shots.Num(); i++)
+	{
+		if ((uint16)(Shots[i].Sequence - Shots[i - 1].Sequence) != 1)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+bool AWeapon::ConsumeShotAllowance()
+{
+	const float Now = GetWorld()->GetTimeSeconds();
+	const float TimeBetweenShots = FMath::Max(GetStats().TimeBetweenShots, KINDA_SMALL_NUMBER);
+
+	ShotAllowance = FMath::Min(ShotAllowance + (Now - ShotAllowanceTime) / TimeBetweenShots, (float)ShotRedundancy);
+	ShotAllowanceTime = Now;
+
+	if (ShotAllowance < 1.f)
+	{
+		return false;
+	}
+
+	ShotAllowance -= 1.f;
+	return true;
+}
+
+
+void AWeapon::ApplyShot(const FWeaponShot& Shot)
+{
+	const bool bShouldUpdateAmmo = (AmmoState.AmmoInClip > 0 && CanFire());
+
+	HandleFiringAt(Shot.Time);
+
+	if (bShouldUpdateAmmo)
+	{
+		FireWeapon(Shot);
+
+		UseAmmo();
+
+		// Update firing FX on remote clients
+		FireState.IncrementBurstCounter();
+	}
+}
+
+
+int32 AWeapon::GetShotSeed(uint16 Sequence) const
+{
+	/* Consecutive sequences should not give similar patterns */
+	return (int32)HashCombine((uint32)Sequence * 2654435761u, (uint32)ShotSeedSalt);
+}
+
+
+bool AWeapon::IsNewerShot(uint16 A, uint16 B)
+{
+	return (int16)(A - B) > 0;
 }
 
 
 bool AWeapon::CanFire() const
 {
-	bool bPawnCanFire = MyPawn && MyPawn->CanFire();
-	bool bStateOK = CurrentState == EWeaponState::Idle || CurrentState == EWeaponState::Firing;
-	return bPawnCanFire && bStateOK && !bPendingReload;
+	return FWeaponStateMachine::CanFire((FWeaponStateMachine::EState)CurrentState, GetStateInputs());
 }
 
 
@@ -313,11 +636,9 @@ FVector AWeapon::GetCameraDamageStartLocation(const FVector& AimDir) const
 }
 
 
-FHitResult AWeapon::WeaponTrace(const FVector& TraceFrom, const FVector& TraceTo) const
+FHitResult AWeapon::WeaponTrace(const FVector& TraceFrom, const FVector& TraceTo, bool bIgnoreCharacters) const
 {
-	FCollisionQueryParams TraceParams(TEXT("WeaponTrace"), true, Instigator);
-	TraceParams.bTraceAsyncScene = true;
-	TraceParams.bReturnPhysicalMaterial = true;
+	const FCollisionQueryParams TraceParams = AWeaponTraceManager::MakeTraceParams(GetWorld(), Instigator, bIgnoreCharacters);
 
 	FHitResult Hit(ForceInit);
 	GetWorld()->LineTraceSingleByChannel(Hit, TraceFrom, TraceTo, COLLISION_WEAPON, TraceParams);
@@ -326,89 +647,132 @@ FHitResult AWeapon::WeaponTrace(const FVector& TraceFrom, const FVector& TraceTo
 }
 
 
+void AWeapon::QueueWeaponTrace(const FVector& TraceFrom, const FVector& TraceTo, const FWeaponTraceDelegate& OnComplete, bool bIgnoreCharacters) const
+{
+	AWeaponTraceManager* const TraceManager = AWeaponTraceManager::Get(this);
+	if (TraceManager)
+	{
+		TraceManager->QueueTrace(TraceFrom, TraceTo, Instigator, OnComplete, bIgnoreCharacters);
+	}
+	else
+	{
+		OnComplete.ExecuteIfBound(WeaponTrace(TraceFrom, TraceTo, bIgnoreCharacters));
+	}
+}
+
+
 
 void AWeapon::HandleFiring()
 {
-	if (CurrentAmmoInClip > 0 && CanFire())
+	HandleFiringAt(GetWorld()->GetTimeSeconds());
+}
+
+
+void AWeapon::HandleFiringAt(float ShotTime)
+{
+	CurrentShotTime = ShotTime;
+	bool bUsedAmmo = false;
+
+	const bool bLocallyControlled = MyPawn && MyPawn->IsLocallyControlled();
+	const FWeaponShot Shot = bLocallyControlled ? MakeLocalShot() : FWeaponShot();
+
+	if (AmmoState.AmmoInClip > 0 && CanFire())
 	{
 		if (GetNetMode() != NM_DedicatedServer)
 		{
 			SimulateWeaponFire();
 		}
 
-		if (MyPawn && MyPawn->IsLocallyControlled())
+		if (bLocallyControlled)
 		{
-			FireWeapon();
+			FireWeapon(Shot);
 
 			UseAmmo();
+			bUsedAmmo = true;
 
 			// Update firing FX on remote clients if this is called on server
-			BurstCounter++;
+			FireState.IncrementBurstCounter();
 		}
 	}
 	else if (CanReload())
 	{
 		StartReload();
 	}
-	else if (MyPawn && MyPawn->IsLocallyControlled())
+	else if (bLocallyControlled)
 	{
 		if (GetCurrentAmmo() == 0 && !bRefiring)
 		{
-			PlayWeaponSound(OutOfAmmoSound);
+			PlayWeaponSound(Definition->OutOfAmmoSound);
 		}
 
 		/* Reload after firing last round */
-		if (CurrentAmmoInClip <= 0 && CanReload())
+		if (AmmoState.AmmoInClip <= 0 && CanReload())
 		{
 			StartReload();
 		}
 
 		/* Stop weapon fire FX, but stay in firing state */
-		if (BurstCounter > 0)
+		if (FireState.BurstCounter > 0)
 		{
 			OnBurstFinished();
 		}
 	}
 
-	if (MyPawn && MyPawn->IsLocallyControlled())
+	if (bLocallyControlled)
 	{
 		if (Role < ROLE_Authority)
 		{
-			ServerHandleFiring();
+			SendShot(Shot, bUsedAmmo);
 		}
 
 		/* Retrigger HandleFiring on a delay for automatic weapons */
-		bRefiring = (CurrentState == EWeaponState::Firing && TimeBetweenShots > 0.0f);
+		bRefiring = (CurrentState == EWeaponState::Firing && GetStats().TimeBetweenShots > 0.0f);
 		if (bRefiring)
 		{
-			GetWorldTimerManager().SetTimer(TimerHandle_HandleFiring, this, &AWeapon::HandleFiring, TimeBetweenShots, false);
+			/* The scheduler keeps its own time for a weapon it already fires, so shots do not drift to frame boundaries */
+			AWeaponFireScheduler* const Scheduler = AWeaponFireScheduler::Get(this);
+			if (Scheduler)
+			{
+				Scheduler->StartFiring(this, ShotTime + GetStats().TimeBetweenShots, GetStats().TimeBetweenShots);
+			}
+			else
+			{
+				GetWorldTimerManager().SetTimer(TimerHandle_HandleFiring, this, &AWeapon::HandleFiring, GetStats().TimeBetweenShots, false);
+			}
 		}
 	}
 
-	/* Make Noise on every shot. The data is managed by the PawnNoiseEmitterComponent created in SBaseCharacter and used by PawnSensingComponent in SZombieCharacter */
+	/* Make Noise on every shot. Folded into the noise field the guards sample, or broadcast to PawnSensingComponent without one */
 	if (MyPawn)
 	{
 		MyPawn->MakePawnNoise(1.0f);
 	}
 
-	LastFireTime = GetWorld()->GetTimeSeconds();
+	LastFireTime = ShotTime;
+}
+
+
+float AWeapon::GetShotServerTime() const
+{
+	const AGameStateBase* const GS = GetWorld()->GetGameState();
+	return GS ? CurrentShotTime + GS->GetServerWorldTimeSeconds() - GetWorld()->GetTimeSeconds() : CurrentShotTime;
 }
 
 
 void AWeapon::SimulateWeaponFire()
 {
-	if (MuzzleFX)
+	if (Definition->MuzzleFX)
 	{
-		MuzzlePSC = UGameplayStatics::SpawnEmitterAttached(MuzzleFX, Mesh, MuzzleAttachPoint);
+		MuzzlePSC = AWeaponEffectsPool::SpawnMuzzleFlash(this, Definition->MuzzleFX, Mesh, Definition->MuzzleAttachPoint);
 	}
 
 	if (!bPlayingFireAnim)
 	{
-		PlayWeaponAnimation(FireAnim);
+		PlayWeaponAnimation(Definition->FireAnim);
 		bPlayingFireAnim = true;
 	}
 
-	PlayWeaponSound(FireSound);
+	PlayWeaponSound(Definition->FireSound);
 }
 
 
@@ -416,71 +780,129 @@ void AWeapon::StopSimulatingWeaponFire()
 {
 	if (bPlayingFireAnim)
 	{
-		StopWeaponAnimation(FireAnim);
+		StopWeaponAnimation(Definition->FireAnim);
 		bPlayingFireAnim = false;
 	}
 }
 
 
 
-void AWeapon::OnRep_BurstCounter()
+void AWeapon::OnRep_AmmoState()
 {
-	if (BurstCounter > 0)
+	if (MyPawn && MyPawn->IsLocallyControlled())
 	{
-		SimulateWeaponFire();
+		ReconcilePredictedState();
 	}
-	else
+}
+
+
+void AWeapon::OnRep_FireState(const FWeaponFireState& PreviousState)
+{
+	if (FireState.BurstCounter != PreviousState.BurstCounter)
 	{
-		StopSimulatingWeaponFire();
+		OnBurstCounterChanged();
 	}
-}
 
+	if (FireState.bPendingReload != PreviousState.bPendingReload)
+	{
+		OnPendingReloadChanged();
+	}
+}
 
 
-bool AWeapon::ServerHandleFiring_Validate()
+void AWeapon::ReconcilePredictedState()
 {
-	return true;
+	/* Events the server has confirmed are in the replicated counts. Anything older than a second
+	   was refused by the server and is dropped, the counts then simply follow the server. */
+	const FWeaponAmmoState& ServerState = AmmoState;
+	const float OldestTime = GetWorld()->GetTimeSeconds() - 1.0f;
+
+	PredictedEvents.RemoveAll([&](const FPredictedWeaponEvent& Event)
+	{
+		if (Event.Time < OldestTime)
+		{
+			return true;
+		}
+		if (Event.bReload)
+		{
+			const uint8 Ahead = (Event.ReloadCount - ServerState.ReloadCount) & FWeaponAmmoState::ReloadCountMask;
+			return Ahead == 0 || Ahead > FWeaponAmmoState::ReloadCountMask / 2;
+		}
+		return !IsNewerShot(Event.ShotSequence, ServerState.ShotSequence);
+	});
+
+	if (PredictedEvents.Num() == 0)
+	{
+		PredictedReloadCount = ServerState.ReloadCount;
+		return;
+	}
+
+	for (const FPredictedWeaponEvent& Event : PredictedEvents)
+	{
+		if (Event.bReload)
+		{
+			AmmoState.AmmoInClip += FWeaponStateMachine::GetReloadAmount(AmmoState.Ammo, AmmoState.AmmoInClip, GetStats().MaxAmmoPerClip);
+		}
+		else if (Event.bUsedAmmo && AmmoState.AmmoInClip > 0)
+		{
+			UseAmmo();
+		}
+	}
 }
 
 
-void AWeapon::ServerHandleFiring_Implementation()
+void AWeapon::AddPredictedReload()
 {
-	const bool bShouldUpdateAmmo = (CurrentAmmoInClip > 0 && CanFire());
+	PredictedReloadCount = (PredictedReloadCount + 1) & FWeaponAmmoState::ReloadCountMask;
+
+	FPredictedWeaponEvent Event;
+	Event.ShotSequence = NextShotSequence - 1;
+	Event.ReloadCount = PredictedReloadCount;
+	Event.bReload = true;
+	Event.bUsedAmmo = false;
+	Event.Time = GetWorld()->GetTimeSeconds();
+	PredictedEvents.Add(Event);
+}
 
-	HandleFiring();
 
-	if (bShouldUpdateAmmo)
+void AWeapon::OnBurstCounterChanged()
+{
+	if (FireState.BurstCounter > 0)
 	{
-		UseAmmo();
-
-		// Update firing FX on remote clients
-		BurstCounter++;
+		SimulateWeaponFire();
+	}
+	else
+	{
+		StopSimulatingWeaponFire();
 	}
 }
 
 
+
 void AWeapon::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
 	DOREPLIFETIME(AWeapon, MyPawn);
 
-	DOREPLIFETIME_CONDITION(AWeapon, CurrentAmmo, COND_OwnerOnly);
-	DOREPLIFETIME_CONDITION(AWeapon, CurrentAmmoInClip, COND_OwnerOnly);
-	DOREPLIFETIME_CONDITION(AWeapon, BurstCounter, COND_SkipOwner);
-	DOREPLIFETIME_CONDITION(AWeapon, bPendingReload, COND_SkipOwner);
+	DOREPLIFETIME_CONDITION(AWeapon, AmmoState, COND_OwnerOnly);
+
+	DOREPLIFETIME_CONDITION(AWeapon, FireState, COND_SkipOwner);
+
+	/* Only the owner traces its shots besides the server */
+	DOREPLIFETIME_CONDITION(AWeapon, ShotSeedSalt, COND_OwnerOnly);
 }
 
 
 FVector AWeapon::GetMuzzleLocation() const
 {
-	return Mesh->GetSocketLocation(MuzzleAttachPoint);
+	return Mesh->GetSocketLocation(Definition->MuzzleAttachPoint);
 }
 
 
 FVector AWeapon::GetMuzzleDirection() const
 {
-	return Mesh->GetSocketRotation(MuzzleAttachPoint).Vector();
+	return Mesh->GetSocketRotation(Definition->MuzzleAttachPoint).Vector();
 }
 
 
@@ -504,16 +926,16 @@ EWeaponState AWeapon::GetCurrentState() const
 
 void AWeapon::SetWeaponState(EWeaponState NewState)
 {
-	const EWeaponState PrevState = CurrentState;
+	const uint8 Effects = FWeaponStateMachine::GetTransitionEffects((FWeaponStateMachine::EState)CurrentState, (FWeaponStateMachine::EState)NewState);
 
-	if (PrevState == EWeaponState::Firing && NewState != EWeaponState::Firing)
+	if (Effects & FWeaponStateMachine::BurstFinished)
 	{
 		OnBurstFinished();
 	}
 
 	CurrentState = NewState;
 
-	if (PrevState != EWeaponState::Firing && NewState == EWeaponState::Firing)
+	if (Effects & FWeaponStateMachine::BurstStarted)
 	{
 		OnBurstStarted();
 	}
@@ -524,10 +946,18 @@ void AWeapon::OnBurstStarted()
 {
 	// Start firing, can be delayed to satisfy TimeBetweenShots
 	const float GameTime = GetWorld()->GetTimeSeconds();
-	if (LastFireTime > 0 && TimeBetweenShots > 0.0f &&
-		LastFireTime + TimeBetweenShots > GameTime)
+	if (LastFireTime > 0 && GetStats().TimeBetweenShots > 0.0f &&
+		LastFireTime + GetStats().TimeBetweenShots > GameTime)
 	{
-		GetWorldTimerManager().SetTimer(TimerHandle_HandleFiring, this, &AWeapon::HandleFiring, LastFireTime + TimeBetweenShots - GameTime, false);
+		AWeaponFireScheduler* const Scheduler = AWeaponFireScheduler::Get(this);
+		if (Scheduler && MyPawn && MyPawn->IsLocallyControlled())
+		{
+			Scheduler->StartFiring(this, LastFireTime + GetStats().TimeBetweenShots, GetStats().TimeBetweenShots);
+		}
+		else
+		{
+			GetWorldTimerManager().SetTimer(TimerHandle_HandleFiring, this, &AWeapon::HandleFiring, LastFireTime + GetStats().TimeBetweenShots - GameTime, false);
+		}
 	}
 	else
 	{
@@ -538,7 +968,7 @@ void AWeapon::OnBurstStarted()
 
 void AWeapon::OnBurstFinished()
 {
-	BurstCounter = 0;
+	FireState.BurstCounter = 0;
 
 	if (GetNetMode() != NM_DedicatedServer)
 	{
@@ -546,38 +976,36 @@ void AWeapon::OnBurstFinished()
 	}
 
 	GetWorldTimerManager().ClearTimer(TimerHandle_HandleFiring);
+	AWeaponFireScheduler* const Scheduler = AWeaponFireScheduler::Get(this);
+	if (Scheduler)
+	{
+		Scheduler->StopFiring(this);
+	}
 	bRefiring = false;
 }
 
 
 void AWeapon::DetermineWeaponState()
 {
-	EWeaponState NewState = EWeaponState::Idle;
+	const FWeaponStateMachine::EState NewState = FWeaponStateMachine::DetermineState((FWeaponStateMachine::EState)CurrentState, GetStateInputs());
+
+	SetWeaponState((EWeaponState)NewState);
+}
 
-	if (bIsEquipped)
-	{
-		if (bPendingReload)
-		{
-			if (CanReload())
-			{
-				NewState = EWeaponState::Reloading;
-			}
-			else
-			{
-				NewState = CurrentState;
-			}
-		}
-		else if (!bPendingReload && bWantsToFire && CanFire())
-		{
-			NewState = EWeaponState::Firing;
-		}
-	}
-	else if (bPendingEquip)
-	{
-		NewState = EWeaponState::Equipping;
-	}
 
-	SetWeaponState(NewState);
+FWeaponStateInputs AWeapon::GetStateInputs() const
+{
+	FWeaponStateInputs Inputs;
+	Inputs.bEquipped = bIsEquipped;
+	Inputs.bPendingEquip = bPendingEquip;
+	Inputs.bWantsToFire = bWantsToFire;
+	Inputs.bPendingReload = FireState.bPendingReload;
+	Inputs.bPawnCanFire = MyPawn && MyPawn->CanFire();
+	Inputs.bPawnCanReload = !MyPawn || MyPawn->CanReload();
+	Inputs.Ammo = AmmoState.Ammo;
+	Inputs.AmmoInClip = AmmoState.AmmoInClip;
+	Inputs.MaxAmmoPerClip = GetStats().MaxAmmoPerClip;
+	return Inputs;
 }
 
 
@@ -633,7 +1061,7 @@ void AWeapon::OnEquipFinished()
 	{
 		// Try to reload empty clip
 		if (MyPawn->IsLocallyControlled() &&
-			CurrentAmmoInClip <= 0 &&
+			AmmoState.AmmoInClip <= 0 &&
 			CanReload())
 		{
 			StartReload();
@@ -645,16 +1073,15 @@ void AWeapon::OnEquipFinished()
 
 void AWeapon::UseAmmo()
 {
-	CurrentAmmoInClip--;
-	CurrentAmmo--;
+	FWeaponStateMachine::UseAmmo(AmmoState.Ammo, AmmoState.AmmoInClip);
 }
 
 
 int32 AWeapon::GiveAmmo(int32 AddAmount)
 {
-	const int32 MissingAmmo = FMath::Max(0, MaxAmmo - CurrentAmmo);
+	const int32 MissingAmmo = FMath::Max(0, GetStats().MaxAmmo - AmmoState.Ammo);
 	AddAmount = FMath::Min(AddAmount, MissingAmmo);
-	CurrentAmmo += AddAmount;
+	AmmoState.Ammo += AddAmount;
 
 	/* Push reload request to client */
 	if (GetCurrentAmmoInClip() <= 0 && CanReload() &&
@@ -670,32 +1097,38 @@ int32 AWeapon::GiveAmmo(int32 AddAmount)
 
 void AWeapon::SetAmmoCount(int32 NewTotalAmount)
 {
-	CurrentAmmo = FMath::Min(MaxAmmo, NewTotalAmount);
-	CurrentAmmoInClip = FMath::Min(MaxAmmoPerClip, CurrentAmmo);
+	AmmoState.Ammo = FMath::Min(GetStats().MaxAmmo, NewTotalAmount);
+	AmmoState.AmmoInClip = FMath::Min(GetStats().MaxAmmoPerClip, AmmoState.Ammo);
 }
 
 
 int32 AWeapon::GetCurrentAmmo() const
 {
-	return CurrentAmmo;
+	return AmmoState.Ammo;
 }
 
 
 int32 AWeapon::GetCurrentAmmoInClip() const
 {
-	return CurrentAmmoInClip;
+	return AmmoState.AmmoInClip;
 }
 
 
 int32 AWeapon::GetMaxAmmoPerClip() const
 {
-	return MaxAmmoPerClip;
+	return GetStats().MaxAmmoPerClip;
 }
 
 
 int32 AWeapon::GetMaxAmmo() const
 {
-	return MaxAmmo;
+	return GetStats().MaxAmmo;
+}
+
+
+int32 AWeapon::GetStartAmmo() const
+{
+	return GetStats().StartAmmo;
 }
 
 
@@ -710,24 +1143,25 @@ void AWeapon::StartReload(bool bFromReplication)
 	/* If local execute requested or we are running on the server */
 	if (bFromReplication || CanReload())
 	{
-		bPendingReload = true;
+		FireState.bPendingReload = true;
 		DetermineWeaponState();
 
-		float AnimDuration = PlayWeaponAnimation(ReloadAnim);
+		float AnimDuration = PlayWeaponAnimation(Definition->ReloadAnim);
 		if (AnimDuration <= 0.0f)
 		{
-			AnimDuration = NoAnimReloadDuration;
+			AnimDuration = Definition->NoAnimReloadDuration;
 		}
 
 		GetWorldTimerManager().SetTimer(TimerHandle_StopReload, this, &AWeapon::StopSimulateReload, AnimDuration, false);
-		if (Role == ROLE_Authority)
+		/* The owner refills its clip on the same timer instead of waiting for the server's ammo */
+		if (Role == ROLE_Authority || (MyPawn && MyPawn->IsLocallyControlled()))
 		{
 			GetWorldTimerManager().SetTimer(TimerHandle_ReloadWeapon, this, &AWeapon::ReloadWeapon, FMath::Max(0.1f, AnimDuration - 0.1f), false);
 		}
 
 		if (MyPawn && MyPawn->IsLocallyControlled())
 		{
-			PlayWeaponSound(ReloadSound);
+			PlayWeaponSound(Definition->ReloadSound);
 		}
 	}
 }
@@ -737,36 +1171,37 @@ void AWeapon::StopSimulateReload()
 {
 	if (CurrentState == EWeaponState::Reloading)
 	{
-		bPendingReload = false;
+		FireState.bPendingReload = false;
 		DetermineWeaponState();
-		StopWeaponAnimation(ReloadAnim);
+		StopWeaponAnimation(Definition->ReloadAnim);
 	}
 }
 
 
 void AWeapon::ReloadWeapon()
 {
-	int32 ClipDelta = FMath::Min(MaxAmmoPerClip - CurrentAmmoInClip, CurrentAmmo - CurrentAmmoInClip);
+	AmmoState.AmmoInClip += FWeaponStateMachine::GetReloadAmount(AmmoState.Ammo, AmmoState.AmmoInClip, GetStats().MaxAmmoPerClip);
 
-	if (ClipDelta > 0)
+	if (Role == ROLE_Authority)
 	{
-		CurrentAmmoInClip += ClipDelta;
+		AmmoState.ReloadCount = (AmmoState.ReloadCount + 1) & FWeaponAmmoState::ReloadCountMask;
+	}
+	else
+	{
+		AddPredictedReload();
 	}
 }
 
 
 bool AWeapon::CanReload()
 {
-	bool bCanReload = (!MyPawn || MyPawn->CanReload());
-	bool bGotAmmo = (CurrentAmmoInClip < MaxAmmoPerClip) && ((CurrentAmmo - CurrentAmmoInClip) > 0);
-	bool bStateOKToReload = ((CurrentState == EWeaponState::Idle) || (CurrentState == EWeaponState::Firing));
-	return (bCanReload && bGotAmmo && bStateOKToReload);
+	return FWeaponStateMachine::CanReload((FWeaponStateMachine::EState)CurrentState, GetStateInputs());
 }
 
 
-void AWeapon::OnRep_Reload()
+void AWeapon::OnPendingReloadChanged()
 {
-	if (bPendingReload)
+	if (FireState.bPendingReload)
 	{
 		/* By passing true we do not push back to server and execute it locally */
 		StartReload(true);
@@ -805,4 +1240,86 @@ bool AWeapon::ServerStopReload_Validate()
 void AWeapon::ClientStartReload_Implementation()
 {
 	StartReload();
-}
\ No newline at end of file
+}
+
+
+bool FWeaponAmmoState::operator==(const FWeaponAmmoState& Other) const
+{
+	return Ammo == Other.Ammo && AmmoInClip == Other.AmmoInClip && ShotSequence == Other.ShotSequence && ReloadCount == Other.ReloadCount;
+}
+
+
+void FWeaponFireState::IncrementBurstCounter()
+{
+	BurstCounter = BurstCounter >= MaxBurstCounter ? 1 : BurstCounter + 1;
+}
+
+
+bool FWeaponFireState::operator==(const FWeaponFireState& Other) const
+{
+	return BurstCounter == Other.BurstCounter && bPendingReload == Other.bPendingReload;
+}
+
+
+void FWeaponShot::Quantize()
+{
+	FBitWriter Writer(256);
+	bool bOutSuccess = true;
+	Origin.NetSerialize(Writer, nullptr, bOutSuccess);
+	Aim.NetSerialize(Writer, nullptr, bOutSuccess);
+
+	FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+	Origin.NetSerialize(Reader, nullptr, bOutSuccess);
+	Aim.NetSerialize(Reader, nullptr, bOutSuccess);
+}
+
+
+/* A 5 bit length followed by that many value bits, so small counts stay small on the wire */
+static void SerializeAmmoCount(FArchive& Ar, int32& Count)
+{
+	uint32 Value = (uint32)FMath::Clamp(Count, 0, (int32)MAX_uint16);
+	uint32 NumBits = Value > 0 ? FMath::FloorLog2(Value) + 1 : 0;
+
+	Ar.SerializeInt(NumBits, 17);
+	if (Ar.IsLoading())
+	{
+		Value = 0;
+	}
+	if (NumBits > 0)
+	{
+		Ar.SerializeBits(&Value, NumBits);
+	}
+
+	Count = (int32)Value;
+}
+
+
+bool FWeaponAmmoState::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	SerializeAmmoCount(Ar, Ammo);
+	SerializeAmmoCount(Ar, AmmoInClip);
+
+	Ar << ShotSequence;
+
+	uint32 Reloads = ReloadCount;
+	Ar.SerializeInt(Reloads, ReloadCountMask + 1);
+	ReloadCount = (uint8)Reloads;
+
+	bOutSuccess = true;
+	return true;
+}
+
+
+bool FWeaponFireState::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	uint32 Burst = BurstCounter;
+	Ar.SerializeInt(Burst, MaxBurstCounter + 1);
+	BurstCounter = (uint8)Burst;
+
+	uint8 bReload = bPendingReload ? 1 : 0;
+	Ar.SerializeBits(&bReload, 1);
+	bPendingReload = bReload != 0;
+
+	bOutSuccess = true;
+	return true;
+}
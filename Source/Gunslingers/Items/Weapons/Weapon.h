@@ -4,6 +4,9 @@
 
 #include "GameFramework/Actor.h"
 #include "../../Characters/PlayerCharacter.h"
+#include "WeaponTraceManager.h"
+#include "WeaponDefinition.h"
+#include "WeaponStateMachine.h"
 #include "Weapon.generated.h"
 
 UENUM()
@@ -15,6 +18,118 @@ enum class EWeaponState
 	Reloading
 };
 
+/* One shot of the owning client, streamed to the server. A shotgun blast is one shot as well,
+   its pellet pattern is seeded from Sequence so both sides trace the same pellets. */
+USTRUCT()
+struct FWeaponShot
+{
+	GENERATED_USTRUCT_BODY()
+
+	/* Wraps around, compared with IsNewerShot */
+	UPROPERTY()
+	uint16 Sequence;
+
+	/* Server time the shot was fired at, as estimated by the client */
+	UPROPERTY()
+	float Time;
+
+	/* Where the shot's traces start */
+	UPROPERTY()
+	FVector_NetQuantize Origin;
+
+	/* Adjusted aim the pellets spread around */
+	UPROPERTY()
+	FVector_NetQuantizeNormal Aim;
+
+	/* Round Origin and Aim the way the stream sends them, so the owner traces what the server traces */
+	void Quantize();
+};
+
+/* Ammo of a weapon and how far the server got in the owner's shots and reloads. Only the owner
+   needs it, replicated to it as one bit packed value whenever any part of it changes. */
+USTRUCT()
+struct FWeaponAmmoState
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	int32 Ammo;
+
+	UPROPERTY()
+	int32 AmmoInClip;
+
+	/* Newest owner shot the server has applied, these counts include it */
+	UPROPERTY()
+	uint16 ShotSequence;
+
+	/* Reloads the server has finished, wraps at ReloadCountMask */
+	UPROPERTY()
+	uint8 ReloadCount;
+
+	static const uint8 ReloadCountMask = 15;
+
+	FWeaponAmmoState()
+		: Ammo(0),
+		AmmoInClip(0),
+		ShotSequence(0),
+		ReloadCount(0)
+	{
+	}
+
+	bool operator==(const FWeaponAmmoState& Other) const;
+
+	/* Ammo counts are sent with only as many bits as their value needs, the reload counter in 4 bits */
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FWeaponAmmoState> : public TStructOpsTypeTraitsBase
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
+
+/* Firing and reloading as other players see them, 5 bits. The owner simulates both itself and never receives it. */
+USTRUCT()
+struct FWeaponFireState
+{
+	GENERATED_USTRUCT_BODY()
+
+	/* Shots of the current burst, wraps from MaxBurstCounter back to 1. 0 when not firing. */
+	UPROPERTY()
+	uint8 BurstCounter;
+
+	UPROPERTY()
+	bool bPendingReload;
+
+	static const uint8 MaxBurstCounter = 15;
+
+	FWeaponFireState()
+		: BurstCounter(0),
+		bPendingReload(false)
+	{
+	}
+
+	void IncrementBurstCounter();
+
+	bool operator==(const FWeaponFireState& Other) const;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FWeaponFireState> : public TStructOpsTypeTraitsBase
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
+
 /**
 *
 */
@@ -23,8 +138,15 @@ class AWeapon : public AActor
 {
 	GENERATED_BODY()
 
+	friend class AWeaponFireScheduler;
+
 		virtual void PostInitializeComponents() override;
 
+	/* Moves the tuning of weapon blueprints saved before UWeaponDefinition into a definition */
+	virtual void PostLoad() override;
+
+	virtual void BeginPlay() override;
+
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	float GetEquipStartedTime() const;
@@ -45,16 +167,73 @@ class AWeapon : public AActor
 
 	FTimerHandle EquipFinishedTimerHandle;
 
-	UPROPERTY(EditDefaultsOnly, Category = "Weapon")
-		float ShotsPerMinute;
-
 protected:
 
 	AWeapon(const FObjectInitializer& ObjectInitializer);
 
-	/* The character socket to store this item at. */
+	/* Shared tuning of this weapon type, the class defaults of UWeaponDefinition when not set */
 	UPROPERTY(EditDefaultsOnly, Category = "Weapon")
-		EInventorySlot StorageSlot;
+		UWeaponDefinition* Definition;
+
+	FORCEINLINE const FWeaponStats& GetStats() const
+	{
+		return Definition->GetStats();
+	}
+
+#if WITH_EDITORONLY_DATA
+	/* Copy the deprecated per weapon tuning into NewDefinition */
+	virtual void MigrateDeprecatedTuning(UWeaponDefinition* NewDefinition) const;
+
+	/* Tuning weapons kept on themselves before UWeaponDefinition, redirected from the old names in
+	   DefaultEngine.ini and only loaded in the editor to be migrated, cooked weapons do not carry it */
+	UPROPERTY()
+		EInventorySlot StorageSlot_DEPRECATED;
+
+	UPROPERTY()
+		float ShotsPerMinute_DEPRECATED;
+
+	UPROPERTY()
+		int32 StartAmmo_DEPRECATED;
+
+	UPROPERTY()
+		int32 MaxAmmo_DEPRECATED;
+
+	UPROPERTY()
+		int32 MaxAmmoPerClip_DEPRECATED;
+
+	UPROPERTY()
+		USoundBase* FireSound_DEPRECATED;
+
+	UPROPERTY()
+		USoundBase* EquipSound_DEPRECATED;
+
+	UPROPERTY()
+		USoundBase* OutOfAmmoSound_DEPRECATED;
+
+	UPROPERTY()
+		USoundBase* ReloadSound_DEPRECATED;
+
+	UPROPERTY()
+		UAnimMontage* EquipAnim_DEPRECATED;
+
+	UPROPERTY()
+		UAnimMontage* FireAnim_DEPRECATED;
+
+	UPROPERTY()
+		UAnimMontage* ReloadAnim_DEPRECATED;
+
+	UPROPERTY()
+		float NoAnimReloadDuration_DEPRECATED;
+
+	UPROPERTY()
+		float NoEquipAnimDuration_DEPRECATED;
+
+	UPROPERTY()
+		UParticleSystem* MuzzleFX_DEPRECATED;
+
+	UPROPERTY()
+		FName MuzzleAttachPoint_DEPRECATED;
+#endif
 
 	/** pawn owner */
 	UPROPERTY(Transient, ReplicatedUsing = OnRep_MyPawn)
@@ -99,7 +278,7 @@ public:
 
 	FORCEINLINE EInventorySlot GetStorageSlot()
 	{
-		return StorageSlot;
+		return Definition->StorageSlot;
 	}
 
 	/************************************************************************/
@@ -125,10 +304,21 @@ protected:
 
 	FVector GetCameraDamageStartLocation(const FVector& AimDir) const;
 
-	FHitResult WeaponTrace(const FVector& TraceFrom, const FVector& TraceTo) const;
+	FHitResult WeaponTrace(const FVector& TraceFrom, const FVector& TraceTo, bool bIgnoreCharacters = false) const;
+
+	/* Trace through the weapon trace manager when there is one, OnComplete then runs next frame.
+	   Without a manager the trace is synchronous and OnComplete runs immediately. */
+	void QueueWeaponTrace(const FVector& TraceFrom, const FVector& TraceTo, const FWeaponTraceDelegate& OnComplete, bool bIgnoreCharacters = false) const;
+
+	/* With PURE_VIRTUAL we skip implementing the function in Weapon.cpp and can do this in WeaponInstant.cpp / SFlashlight.cpp instead.
+	   Runs on the shooter, and on the server again for the shots a remote owner streams to it. */
+	virtual void FireWeapon(const FWeaponShot& Shot) PURE_VIRTUAL(AWeapon::FireWeapon, );
 
-	/* With PURE_VIRTUAL we skip implementing the function in Weapon.cpp and can do this in WeaponInstant.cpp / SFlashlight.cpp instead */
-	virtual void FireWeapon() PURE_VIRTUAL(AWeapon::FireWeapon, );
+	/* Seed of the shot's spread, the same on the owner and the server */
+	int32 GetShotSeed(uint16 Sequence) const;
+
+	/* Server time of the shot being fired, exact even when several shots fall into one frame */
+	float GetShotServerTime() const;
 
 private:
 
@@ -136,8 +326,14 @@ private:
 
 	void DetermineWeaponState();
 
+	/* Snapshot of the weapon and its pawn for FWeaponStateMachine */
+	FWeaponStateInputs GetStateInputs() const;
+
 	virtual void HandleFiring();
 
+	/* HandleFiring for a shot due at ShotTime in world time, the fire scheduler passes the exact time of each shot */
+	void HandleFiringAt(float ShotTime);
+
 	UFUNCTION(Reliable, Server, WithValidation)
 		void ServerStartFire();
 
@@ -145,19 +341,101 @@ private:
 
 	bool ServerStartFire_Validate();
 
+	/* Carries the last shots of the burst, so the end of every burst arrives even if the stream loses it */
 	UFUNCTION(Reliable, Server, WithValidation)
-		void ServerStopFire();
+		void ServerStopFire(const TArray<FWeaponShot>& LastShots);
 
-	void ServerStopFire_Implementation();
+	void ServerStopFire_Implementation(const TArray<FWeaponShot>& LastShots);
 
-	bool ServerStopFire_Validate();
+	bool ServerStopFire_Validate(const TArray<FWeaponShot>& LastShots);
 
-	UFUNCTION(Reliable, Server, WithValidation)
-		void ServerHandleFiring();
+	/* Shot stream: each packet repeats the most recent shots, the server drops the ones it already has */
+	UFUNCTION(Unreliable, Server, WithValidation)
+		void ServerFireShots(const TArray<FWeaponShot>& Shots);
+
+	void ServerFireShots_Implementation(const TArray<FWeaponShot>& Shots);
+
+	bool ServerFireShots_Validate(const TArray<FWeaponShot>& Shots);
+
+	/* Owner: number the next shot and capture its aim */
+	FWeaponShot MakeLocalShot();
+
+	/* Client: add a shot to the stream and send the recent ones, bUsedAmmo is what the owner predicted */
+	void SendShot(const FWeaponShot& Shot, bool bUsedAmmo);
+
+	/* Server: apply the shots newer than the last applied one, in sequence order */
+	void ApplyShots(const TArray<FWeaponShot>& Shots);
+
+	/* Server side of one client shot */
+	void ApplyShot(const FWeaponShot& Shot);
+
+	/* Server: a streamed shot must start within a capsule's size of its pawn's eyes, with nothing
+	   blocking the weapon channel between the two */
+	bool IsValidShotOrigin(const FVector& Origin) const;
+
+	/* Picked by the server for each owner and mixed into the spread seeds, so patterns differ between
+	   owners and matches. The owner needs it to predict its spread and knows every pattern ahead,
+	   skipping sequences to pick one costs a round each and is refused past ShotRedundancy. */
+	UPROPERTY(Transient, Replicated)
+	int32 ShotSeedSalt;
+
+	/* Server: sequences missing from the stream, charged as fired shots. An honest stream only misses
+	   shots to packet loss, more than ShotRedundancy in a row is a client picking its spread. */
+	int32 NumSkippedShots;
+
+	static bool IsNewerShot(uint16 A, uint16 B);
+
+	/* The owner sends its recent shots in order, one sequence apart */
+	static bool AreConsecutiveShots(const TArray<FWeaponShot>& Shots);
+
+	/* How many of the latest shots every packet repeats */
+	static const int32 ShotRedundancy = 4;
+
+	/* Client: the latest shots, oldest first */
+	TArray<FWeaponShot> RecentShots;
+
+	uint16 NextShotSequence;
+
+	/* Server: newest shot applied from the stream */
+	uint16 LastAppliedShot;
+
+	float LastAppliedShotTime;
+
+	/* Server: shots the owner may still fire, refilled by one per TimeBetweenShots of server time.
+	   Capped at ShotRedundancy, so shots bunched by jitter or resent after a loss go through but a
+	   client stamping its own times cannot fire faster than the weapon. */
+	float ShotAllowance;
 
-	void ServerHandleFiring_Implementation();
+	/* Server time ShotAllowance was last refilled at */
+	float ShotAllowanceTime;
 
-	bool ServerHandleFiring_Validate();
+	/* Refill the allowance up to now and take one shot from it */
+	bool ConsumeShotAllowance();
+
+	int32 NumDuplicateShots;
+
+	/* Server: shots refused for their time, their origin or for firing faster than the weapon */
+	int32 NumRefusedShots;
+
+	/* An owner shot or reload the server has not confirmed yet */
+	struct FPredictedWeaponEvent
+	{
+		uint16 ShotSequence;
+		uint8 ReloadCount;
+		bool bReload;
+		bool bUsedAmmo;
+		float Time;
+	};
+
+	/* Owner: replay the unconfirmed events on top of the replicated counts */
+	void ReconcilePredictedState();
+
+	void AddPredictedReload();
+
+	/* Owner's timeline, oldest first */
+	TArray<FPredictedWeaponEvent> PredictedEvents;
+
+	uint8 PredictedReloadCount;
 
 	void OnBurstStarted();
 
@@ -171,8 +449,8 @@ private:
 
 	float LastFireTime;
 
-	/* Time between shots for repeating fire */
-	float TimeBetweenShots;
+	/* World time of the shot being fired */
+	float CurrentShotTime;
 
 	/************************************************************************/
 	/* Simulation & FX                                                      */
@@ -180,34 +458,14 @@ private:
 
 private:
 
-	UFUNCTION()
-		void OnRep_BurstCounter();
-
-	UPROPERTY(EditDefaultsOnly, Category = "Sounds")
-		USoundBase* FireSound;
-
-	UPROPERTY(EditDefaultsOnly, Category = "Sounds")
-		USoundBase* EquipSound;
-
-	UPROPERTY(EditDefaultsOnly)
-		UParticleSystem* MuzzleFX;
-
-	UPROPERTY(EditDefaultsOnly)
-		UAnimMontage* EquipAnim;
-
-	UPROPERTY(EditDefaultsOnly)
-		UAnimMontage* FireAnim;
+	/* Plays or stops the firing FX of remote weapons */
+	void OnBurstCounterChanged();
 
 	UPROPERTY(Transient)
 		UParticleSystemComponent* MuzzlePSC;
 
-	UPROPERTY(EditDefaultsOnly)
-		FName MuzzleAttachPoint;
-
 	bool bPlayingFireAnim;
 
-	UPROPERTY(Transient, ReplicatedUsing = OnRep_BurstCounter)
-		int32 BurstCounter;
 
 protected:
 
@@ -231,49 +489,28 @@ protected:
 
 private:
 
-	UPROPERTY(EditDefaultsOnly, Category = "Sounds")
-		USoundBase* OutOfAmmoSound;
-
 	FTimerHandle TimerHandle_ReloadWeapon;
 
 	FTimerHandle TimerHandle_StopReload;
 
 protected:
 
-	/* Time to assign on reload when no animation is found */
-	UPROPERTY(EditDefaultsOnly, Category = "Animation")
-		float NoAnimReloadDuration;
-
-	/* Time to assign on equip when no animation is found */
-	UPROPERTY(EditDefaultsOnly, Category = "Animation")
-		float NoEquipAnimDuration;
-
-	UPROPERTY(Transient, ReplicatedUsing = OnRep_Reload)
-		bool bPendingReload;
-
-	void UseAmmo();
-
-	UPROPERTY(Transient, Replicated)
-		int32 CurrentAmmo;
+	/* Owner only: ammo counts and the last shot and reload the server applied */
+	UPROPERTY(Transient, ReplicatedUsing = OnRep_AmmoState)
+		FWeaponAmmoState AmmoState;
 
-	UPROPERTY(Transient, Replicated)
-		int32 CurrentAmmoInClip;
+	/* Everyone but the owner: burst and reload, the owner simulates firing and reloading itself */
+	UPROPERTY(Transient, ReplicatedUsing = OnRep_FireState)
+		FWeaponFireState FireState;
 
-	/* Weapon ammo on spawn */
-	UPROPERTY(EditDefaultsOnly)
-		int32 StartAmmo;
-
-	UPROPERTY(EditDefaultsOnly)
-		int32 MaxAmmo;
+	UFUNCTION()
+		void OnRep_AmmoState();
 
-	UPROPERTY(EditDefaultsOnly)
-		int32 MaxAmmoPerClip;
+	UFUNCTION()
+		void OnRep_FireState(const FWeaponFireState& PreviousState);
 
-	UPROPERTY(EditDefaultsOnly, Category = "Sounds")
-		USoundBase* ReloadSound;
+	void UseAmmo();
 
-	UPROPERTY(EditDefaultsOnly, Category = "Animation")
-		UAnimMontage* ReloadAnim;
 
 	virtual void ReloadWeapon();
 
@@ -286,8 +523,7 @@ protected:
 	/* Is weapon and character currently capable of starting a reload */
 	bool CanReload();
 
-	UFUNCTION()
-		void OnRep_Reload();
+	void OnPendingReloadChanged();
 
 	UFUNCTION(reliable, server, WithValidation)
 		void ServerStartReload();
@@ -326,4 +562,7 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "Ammo")
 		int32 GetMaxAmmo() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Ammo")
+		int32 GetStartAmmo() const;
 };
\ No newline at end of file
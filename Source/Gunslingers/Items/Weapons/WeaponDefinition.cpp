@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Gunslingers.h"
+#include "WeaponDefinition.h"
+
+
+UWeaponDefinition::UWeaponDefinition()
+{
+	StorageSlot = EInventorySlot::Rifle;
+	ShotsPerMinute = 700;
+	StartAmmo = 999;
+	MaxAmmo = 999;
+	MaxAmmoPerClip = 30;
+
+	HitDamage = 26.f;
+	DamageType = UDamageType::StaticClass();
+	WeaponRange = 15000.f;
+	PelletsPerShot = 1;
+	SpreadAngle = 0.f;
+	ProjectileClass = nullptr;
+
+	FireSound = nullptr;
+	EquipSound = nullptr;
+	OutOfAmmoSound = nullptr;
+	ReloadSound = nullptr;
+	EquipAnim = nullptr;
+	FireAnim = nullptr;
+	ReloadAnim = nullptr;
+	NoAnimReloadDuration = 1.5f;
+	NoEquipAnimDuration = 0.5f;
+
+	MuzzleFX = nullptr;
+	MuzzleAttachPoint = TEXT("MuzzleFlashSocket");
+}
+
+void UWeaponDefinition::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	UpdateStats();
+}
+
+void UWeaponDefinition::PostLoad()
+{
+	Super::PostLoad();
+
+	UpdateStats();
+}
+
+#if WITH_EDITOR
+void UWeaponDefinition::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	UpdateStats();
+}
+#endif
+
+const FImpactEffect& UWeaponDefinition::FindImpactEffect(EPhysicalSurface SurfaceType) const
+{
+	for (const FImpactEffect& SurfaceEffect : SurfaceImpactEffects)
+	{
+		if (SurfaceEffect.SurfaceType == SurfaceType)
+		{
+			return SurfaceEffect;
+		}
+	}
+
+	return DefaultImpactEffect;
+}
+
+void UWeaponDefinition::UpdateStats()
+{
+	Stats.TimeBetweenShots = ShotsPerMinute > 0.f ? 60.0f / ShotsPerMinute : 0.f;
+	Stats.MaxAmmo = FMath::Max(0, MaxAmmo);
+	Stats.MaxAmmoPerClip = FMath::Max(0, MaxAmmoPerClip);
+	Stats.StartAmmo = FMath::Clamp(StartAmmo, 0, Stats.MaxAmmo);
+	Stats.StartAmmoInClip = FMath::Min(Stats.MaxAmmoPerClip, Stats.StartAmmo);
+	Stats.NumPellets = FMath::Max(1, PelletsPerShot);
+	Stats.SpreadHalfAngle = FMath::DegreesToRadians(FMath::Clamp(SpreadAngle, 0.f, 45.f));
+}
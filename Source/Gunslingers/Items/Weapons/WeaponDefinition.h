@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+#include "../../Characters/PlayerCharacter.h"
+#include "WeaponEffectsPool.h"
+#include "WeaponDefinition.generated.h"
+
+/* Values the firing and ammo code reads on every shot, derived once from the definition */
+struct FWeaponStats
+{
+	/* 0 for weapons that do not refire while the trigger is held */
+	float TimeBetweenShots;
+
+	int32 StartAmmo;
+
+	int32 StartAmmoInClip;
+
+	int32 MaxAmmo;
+
+	int32 MaxAmmoPerClip;
+
+	/* Traces per shot, at least 1 */
+	int32 NumPellets;
+
+	/* Cone half angle the shot's traces spread in, radians */
+	float SpreadHalfAngle;
+
+	FWeaponStats()
+		: TimeBetweenShots(0.f),
+		StartAmmo(0),
+		StartAmmoInClip(0),
+		MaxAmmo(0),
+		MaxAmmoPerClip(0),
+		NumPellets(1),
+		SpreadHalfAngle(0.f)
+	{
+	}
+};
+
+/**
+* Tuning of one weapon type, shared by every weapon that uses it. Weapons only keep their own
+* ammo and state, and read everything else from here.
+*/
+UCLASS(BlueprintType)
+class GUNSLINGERS_API UWeaponDefinition : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UWeaponDefinition();
+
+	virtual void PostInitProperties() override;
+
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	FORCEINLINE const FWeaponStats& GetStats() const
+	{
+		return Stats;
+	}
+
+	/* Impact for the surface, DefaultImpactEffect when it has no entry */
+	const FImpactEffect& FindImpactEffect(EPhysicalSurface SurfaceType) const;
+
+	/* Derive the stats again after the tuning was changed from code */
+	void UpdateStats();
+
+	/* The character socket to store this item at. */
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon")
+	EInventorySlot StorageSlot;
+
+	/* 0 for single shot weapons */
+	UPROPERTY(EditDefaultsOnly, Category = "Weapon", meta = (ClampMin = "0"))
+	float ShotsPerMinute;
+
+	/* Weapon ammo on spawn */
+	UPROPERTY(EditDefaultsOnly, Category = "Ammo")
+	int32 StartAmmo;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Ammo")
+	int32 MaxAmmo;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Ammo")
+	int32 MaxAmmoPerClip;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Hitscan")
+	float HitDamage;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Hitscan")
+	TSubclassOf<UDamageType> DamageType;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Hitscan")
+	float WeaponRange;
+
+	/* Traces per shot, each dealing HitDamage. Above 1 for shotguns. */
+	UPROPERTY(EditDefaultsOnly, Category = "Hitscan", meta = (ClampMin = "1"))
+	int32 PelletsPerShot;
+
+	/* Half angle in degrees of the cone the traces spread in, 0 fires straight along the aim */
+	UPROPERTY(EditDefaultsOnly, Category = "Hitscan", meta = (ClampMin = "0", ClampMax = "45"))
+	float SpreadAngle;
+
+	/* Launched from the muzzle by AWeaponProjectile, one per pellet, from the projectile pool when it holds this class */
+	UPROPERTY(EditDefaultsOnly, Category = "Projectile")
+	TSubclassOf<class AGunslingersProjectile> ProjectileClass;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Sounds")
+	USoundBase* FireSound;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Sounds")
+	USoundBase* EquipSound;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Sounds")
+	USoundBase* OutOfAmmoSound;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Sounds")
+	USoundBase* ReloadSound;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Animation")
+	UAnimMontage* EquipAnim;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Animation")
+	UAnimMontage* FireAnim;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Animation")
+	UAnimMontage* ReloadAnim;
+
+	/* Time to assign on reload when no animation is found */
+	UPROPERTY(EditDefaultsOnly, Category = "Animation")
+	float NoAnimReloadDuration;
+
+	/* Time to assign on equip when no animation is found */
+	UPROPERTY(EditDefaultsOnly, Category = "Animation")
+	float NoEquipAnimDuration;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Effects")
+	UParticleSystem* MuzzleFX;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Effects")
+	FName MuzzleAttachPoint;
+
+	/* Impact on surfaces without an entry in SurfaceImpactEffects */
+	UPROPERTY(EditDefaultsOnly, Category = "Effects")
+	FImpactEffect DefaultImpactEffect;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Effects")
+	TArray<FImpactEffect> SurfaceImpactEffects;
+
+private:
+
+	FWeaponStats Stats;
+};
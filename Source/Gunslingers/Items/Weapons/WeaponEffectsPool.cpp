@@ -0,0 +1,236 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Gunslingers.h"
+#include "WeaponEffectsPool.h"
+#include "GunslingersGameMode.h"
+#include "GunslingersGameState.h"
+#include "Components/DecalComponent.h"
+
+DECLARE_STATS_GROUP(TEXT("WeaponEffects"), STATGROUP_WeaponEffects, STATCAT_Advanced);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Components"), STAT_PooledEffectComponents, STATGROUP_WeaponEffects);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effects Played"), STAT_EffectsPlayed, STATGROUP_WeaponEffects);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effects Culled"), STAT_EffectsCulled, STATGROUP_WeaponEffects);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effects Stolen"), STAT_EffectsStolen, STATGROUP_WeaponEffects);
+
+
+AWeaponEffectsPool::AWeaponEffectsPool()
+{
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	FMemory::Memzero(NextSteal);
+
+	MaxComponents[(uint8)EWeaponEffectType::Muzzle] = 16;
+	MaxComponents[(uint8)EWeaponEffectType::Impact] = 32;
+	MaxComponents[(uint8)EWeaponEffectType::Decal] = 64;
+
+	CullDistanceSquared[(uint8)EWeaponEffectType::Muzzle] = FMath::Square(10000.f);
+	CullDistanceSquared[(uint8)EWeaponEffectType::Impact] = FMath::Square(10000.f);
+	CullDistanceSquared[(uint8)EWeaponEffectType::Decal] = FMath::Square(5000.f);
+}
+
+void AWeaponEffectsPool::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const AGunslingersGameMode* const Settings = GetWorld()->GetGameState() ? GetWorld()->GetGameState()->GetDefaultGameMode<AGunslingersGameMode>() : nullptr;
+	if (Settings)
+	{
+		MaxComponents[(uint8)EWeaponEffectType::Muzzle] = FMath::Max(1, Settings->MaxMuzzleEffects);
+		MaxComponents[(uint8)EWeaponEffectType::Impact] = FMath::Max(1, Settings->MaxImpactEffects);
+		MaxComponents[(uint8)EWeaponEffectType::Decal] = FMath::Max(1, Settings->MaxImpactDecals);
+
+		CullDistanceSquared[(uint8)EWeaponEffectType::Muzzle] = FMath::Square(Settings->EffectCullDistance);
+		CullDistanceSquared[(uint8)EWeaponEffectType::Impact] = FMath::Square(Settings->EffectCullDistance);
+		CullDistanceSquared[(uint8)EWeaponEffectType::Decal] = FMath::Square(Settings->DecalCullDistance);
+	}
+}
+
+AWeaponEffectsPool* AWeaponEffectsPool::Get(const UObject* WorldContextObject)
+{
+	const UWorld* const World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	const AGunslingersGameState* const GS = World ? World->GetGameState<AGunslingersGameState>() : nullptr;
+
+	return GS ? GS->GetWeaponEffectsPool() : nullptr;
+}
+
+UParticleSystemComponent* AWeaponEffectsPool::PlayMuzzleFlash(UParticleSystem* FX, USceneComponent* AttachTo, FName AttachPoint)
+{
+	if (FX == nullptr || AttachTo == nullptr || !IsRelevant(EWeaponEffectType::Muzzle, AttachTo->GetSocketLocation(AttachPoint)))
+	{
+		return nullptr;
+	}
+
+	UParticleSystemComponent* const PSC = AcquireParticles(EWeaponEffectType::Muzzle, FX);
+	PSC->AttachToComponent(AttachTo, FAttachmentTransformRules::SnapToTargetNotIncludingScale, AttachPoint);
+	PSC->ActivateSystem(true);
+
+	return PSC;
+}
+
+void AWeaponEffectsPool::PlayImpact(const FHitResult& Impact, const FImpactEffect& Effect)
+{
+	if (Effect.FX && IsRelevant(EWeaponEffectType::Impact, Impact.ImpactPoint))
+	{
+		UParticleSystemComponent* const PSC = AcquireParticles(EWeaponEffectType::Impact, Effect.FX);
+		PSC->SetWorldLocationAndRotation(Impact.ImpactPoint, Impact.ImpactNormal.Rotation());
+		PSC->ActivateSystem(true);
+	}
+
+	/* Decals on moving actors would be left floating, they only go on the level */
+	const AActor* const HitActor = Impact.GetActor();
+	const bool bStaticSurface = HitActor == nullptr || HitActor->GetRootComponent() == nullptr || HitActor->GetRootComponent()->Mobility == EComponentMobility::Static;
+
+	if (Effect.DecalMaterial && bStaticSurface && IsRelevant(EWeaponEffectType::Decal, Impact.ImpactPoint))
+	{
+		UDecalComponent* const Decal = AcquireDecal();
+
+		/* Decals project along their X axis, into the surface */
+		FRotator DecalRotation = (-Impact.ImpactNormal).Rotation();
+		DecalRotation.Roll = FMath::FRandRange(-180.f, 180.f);
+
+		Decal->SetDecalMaterial(Effect.DecalMaterial);
+		Decal->DecalSize = FVector(Effect.DecalSize);
+		Decal->SetWorldLocationAndRotation(Impact.ImpactPoint, DecalRotation);
+		Decal->SetVisibility(true);
+		Decal->MarkRenderStateDirty();
+	}
+}
+
+int32 AWeaponEffectsPool::GetNumComponents() const
+{
+	return MuzzleComponents.Num() + ImpactComponents.Num() + DecalComponents.Num();
+}
+
+UParticleSystemComponent* AWeaponEffectsPool::SpawnMuzzleFlash(const UObject* WorldContextObject, UParticleSystem* FX, USceneComponent* AttachTo, FName AttachPoint)
+{
+	AWeaponEffectsPool* const Pool = Get(WorldContextObject);
+	if (Pool)
+	{
+		return Pool->PlayMuzzleFlash(FX, AttachTo, AttachPoint);
+	}
+
+	return FX ? UGameplayStatics::SpawnEmitterAttached(FX, AttachTo, AttachPoint) : nullptr;
+}
+
+void AWeaponEffectsPool::SpawnImpact(const UObject* WorldContextObject, const FHitResult& Impact, const FImpactEffect& Effect)
+{
+	AWeaponEffectsPool* const Pool = Get(WorldContextObject);
+	if (Pool)
+	{
+		Pool->PlayImpact(Impact, Effect);
+		return;
+	}
+
+	if (Effect.FX)
+	{
+		UGameplayStatics::SpawnEmitterAtLocation(WorldContextObject, Effect.FX, Impact.ImpactPoint, Impact.ImpactNormal.Rotation());
+	}
+
+	if (Effect.DecalMaterial)
+	{
+		UGameplayStatics::SpawnDecalAtLocation(WorldContextObject, Effect.DecalMaterial, FVector(Effect.DecalSize), Impact.ImpactPoint, (-Impact.ImpactNormal).Rotation(), 10.f);
+	}
+}
+
+UParticleSystemComponent* AWeaponEffectsPool::AcquireParticles(EWeaponEffectType Type, UParticleSystem* FX)
+{
+	TArray<UParticleSystemComponent*>& Components = Type == EWeaponEffectType::Muzzle ? MuzzleComponents : ImpactComponents;
+
+	UParticleSystemComponent* PSC = nullptr;
+
+	/* A finished system deactivates itself and is free again */
+	for (UParticleSystemComponent* Candidate : Components)
+	{
+		if (!Candidate->IsActive())
+		{
+			PSC = Candidate;
+			break;
+		}
+	}
+
+	if (PSC == nullptr)
+	{
+		if (Components.Num() < MaxComponents[(uint8)Type])
+		{
+			PSC = NewObject<UParticleSystemComponent>(this);
+			PSC->bAutoActivate = false;
+			PSC->bAutoDestroy = false;
+			PSC->SecondsBeforeInactive = 0.f;
+			PSC->SetupAttachment(RootComponent);
+			PSC->RegisterComponent();
+			Components.Add(PSC);
+			INC_DWORD_STAT(STAT_PooledEffectComponents);
+		}
+		else
+		{
+			int32& Steal = NextSteal[(uint8)Type];
+			Steal = Steal % Components.Num();
+			PSC = Components[Steal++];
+			INC_DWORD_STAT(STAT_EffectsStolen);
+		}
+	}
+
+	if (Type != EWeaponEffectType::Muzzle && PSC->GetAttachParent() != RootComponent)
+	{
+		PSC->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepWorldTransform);
+	}
+
+	if (PSC->Template != FX)
+	{
+		PSC->SetTemplate(FX);
+	}
+
+	INC_DWORD_STAT(STAT_EffectsPlayed);
+	return PSC;
+}
+
+UDecalComponent* AWeaponEffectsPool::AcquireDecal()
+{
+	/* Decals stay until the pool needs them again, the oldest one goes first */
+	UDecalComponent* Decal = nullptr;
+	if (DecalComponents.Num() < MaxComponents[(uint8)EWeaponEffectType::Decal])
+	{
+		Decal = NewObject<UDecalComponent>(this);
+		Decal->SetupAttachment(RootComponent);
+		Decal->RegisterComponent();
+		DecalComponents.Add(Decal);
+		INC_DWORD_STAT(STAT_PooledEffectComponents);
+	}
+	else
+	{
+		int32& Steal = NextSteal[(uint8)EWeaponEffectType::Decal];
+		Steal = Steal % DecalComponents.Num();
+		Decal = DecalComponents[Steal++];
+		INC_DWORD_STAT(STAT_EffectsStolen);
+	}
+
+	INC_DWORD_STAT(STAT_EffectsPlayed);
+	return Decal;
+}
+
+bool AWeaponEffectsPool::IsRelevant(EWeaponEffectType Type, const FVector& Location) const
+{
+	bool bHasViewer = false;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* const PC = It->Get();
+		if (PC && PC->IsLocalController() && PC->PlayerCameraManager)
+		{
+			bHasViewer = true;
+			if (FVector::DistSquared(PC->PlayerCameraManager->GetCameraLocation(), Location) <= CullDistanceSquared[(uint8)Type])
+			{
+				return true;
+			}
+		}
+	}
+
+	/* Nobody to cull against, play it */
+	if (!bHasViewer)
+	{
+		return true;
+	}
+
+	INC_DWORD_STAT(STAT_EffectsCulled);
+	return false;
+}
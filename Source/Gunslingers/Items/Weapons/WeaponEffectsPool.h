@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "WeaponEffectsPool.generated.h"
+
+/* Kinds of pooled effect, each with its own cap and cull distance */
+enum class EWeaponEffectType : uint8
+{
+	Muzzle,
+	Impact,
+	Decal,
+	Count
+};
+
+/* What a shot leaves behind on one kind of surface */
+USTRUCT()
+struct FImpactEffect
+{
+	GENERATED_USTRUCT_BODY()
+
+	/* Surface this entry is for, the weapon's default impact is used for any other */
+	UPROPERTY(EditDefaultsOnly, Category = "Effects")
+	TEnumAsByte<EPhysicalSurface> SurfaceType;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Effects")
+	UParticleSystem* FX;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Effects")
+	UMaterialInterface* DecalMaterial;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Effects")
+	float DecalSize;
+
+	FImpactEffect()
+		: SurfaceType(SurfaceType_Default),
+		FX(nullptr),
+		DecalMaterial(nullptr),
+		DecalSize(8.f)
+	{
+	}
+};
+
+/**
+* Recycles the particle and decal components of weapon effects instead of spawning one per shot.
+* Components are created on demand up to a cap per effect type, after that the oldest one is reused.
+* Effects further than their cull distance from every local player are not played at all.
+*/
+UCLASS()
+class GUNSLINGERS_API AWeaponEffectsPool : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AWeaponEffectsPool();
+
+	virtual void BeginPlay() override;
+
+	/* Pool of the world WorldContextObject is in, null on dedicated servers or when effects are not pooled */
+	static AWeaponEffectsPool* Get(const UObject* WorldContextObject);
+
+	/* Restart a muzzle flash attached to the weapon mesh, null when culled */
+	UParticleSystemComponent* PlayMuzzleFlash(UParticleSystem* FX, USceneComponent* AttachTo, FName AttachPoint);
+
+	/* Particles and decal of Effect at the impact point, decals are only left on the level */
+	void PlayImpact(const FHitResult& Impact, const FImpactEffect& Effect);
+
+	/* Components created so far, stays flat once the pools are warm */
+	UFUNCTION(BlueprintCallable, Category = "Performance")
+	int32 GetNumComponents() const;
+
+	static UParticleSystemComponent* SpawnMuzzleFlash(const UObject* WorldContextObject, UParticleSystem* FX, USceneComponent* AttachTo, FName AttachPoint);
+
+	static void SpawnImpact(const UObject* WorldContextObject, const FHitResult& Impact, const FImpactEffect& Effect);
+
+private:
+
+	UParticleSystemComponent* AcquireParticles(EWeaponEffectType Type, UParticleSystem* FX);
+
+	UDecalComponent* AcquireDecal();
+
+	/* True when Location is within the type's cull distance of a local player */
+	bool IsRelevant(EWeaponEffectType Type, const FVector& Location) const;
+
+	UPROPERTY(Transient)
+	TArray<UParticleSystemComponent*> MuzzleComponents;
+
+	UPROPERTY(Transient)
+	TArray<UParticleSystemComponent*> ImpactComponents;
+
+	UPROPERTY(Transient)
+	TArray<UDecalComponent*> DecalComponents;
+
+	/* Per type, the next component to take over when the pool is full */
+	int32 NextSteal[(uint8)EWeaponEffectType::Count];
+
+	int32 MaxComponents[(uint8)EWeaponEffectType::Count];
+
+	float CullDistanceSquared[(uint8)EWeaponEffectType::Count];
+};
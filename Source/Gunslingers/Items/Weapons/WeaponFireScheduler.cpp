@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Gunslingers.h"
+#include "WeaponFireScheduler.h"
+#include "Weapon.h"
+#include "GunslingersGameState.h"
+
+DECLARE_CYCLE_STAT(TEXT("Schedule Weapon Fire"), STAT_ScheduleWeaponFire, STATGROUP_Game);
+
+
+AWeaponFireScheduler::AWeaponFireScheduler()
+{
+	/* Before the trace manager submits the frame's traces */
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	ShotsLastFrame = 0;
+}
+
+void AWeaponFireScheduler::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	SCOPE_CYCLE_COUNTER(STAT_ScheduleWeaponFire);
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	ShotsLastFrame = 0;
+
+	/* Weapons that start firing during the loop are appended and wait for the next frame */
+	const int32 NumWeapons = Weapons.Num();
+	float ShotTimes[MaxShotsPerFrame];
+	for (int32 i = 0; i < NumWeapons; i++)
+	{
+		if (Weapons[i] == nullptr)
+		{
+			continue;
+		}
+
+		const int32 NumShots = CollectDueShots(NextShotTimes[i], Intervals[i], Now, ShotTimes);
+		for (int32 Shot = 0; Shot < NumShots && Weapons[i]; Shot++)
+		{
+			ShotsLastFrame++;
+
+			/* Clears the slot through StopFiring when the weapon stops refiring */
+			Weapons[i]->HandleFiringAt(ShotTimes[Shot]);
+		}
+	}
+
+	for (int32 i = Weapons.Num() - 1; i >= 0; i--)
+	{
+		if (Weapons[i] == nullptr || Weapons[i]->IsPendingKill())
+		{
+			Weapons.RemoveAtSwap(i, 1, false);
+			NextShotTimes.RemoveAtSwap(i, 1, false);
+			Intervals.RemoveAtSwap(i, 1, false);
+		}
+	}
+}
+
+AWeaponFireScheduler* AWeaponFireScheduler::Get(const UObject* WorldContextObject)
+{
+	const UWorld* const World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	const AGunslingersGameState* const GS = World ? World->GetGameState<AGunslingersGameState>() : nullptr;
+
+	return GS ? GS->GetWeaponFireScheduler() : nullptr;
+}
+
+int32 AWeaponFireScheduler::CollectDueShots(float& NextShotTime, float Interval, float Now, float OutShotTimes[MaxShotsPerFrame])
+{
+	int32 NumShots = 0;
+	while (NextShotTime <= Now)
+	{
+		if (NumShots == MaxShotsPerFrame)
+		{
+			NextShotTime = Now + Interval;
+			break;
+		}
+
+		OutShotTimes[NumShots++] = NextShotTime;
+		NextShotTime += Interval;
+	}
+
+	return NumShots;
+}
+
+void AWeaponFireScheduler::StartFiring(AWeapon* Weapon, float NextShotTime, float Interval)
+{
+	if (Weapon && Interval > 0.f && !IsFiring(Weapon))
+	{
+		Weapons.Add(Weapon);
+		NextShotTimes.Add(NextShotTime);
+		Intervals.Add(Interval);
+	}
+}
+
+void AWeaponFireScheduler::StopFiring(AWeapon* Weapon)
+{
+	const int32 Index = Weapons.Find(Weapon);
+	if (Index != INDEX_NONE)
+	{
+		Weapons[Index] = nullptr;
+	}
+}
+
+bool AWeaponFireScheduler::IsFiring(const AWeapon* Weapon) const
+{
+	return Weapon && Weapons.Contains(Weapon);
+}
+
+int32 AWeaponFireScheduler::GetShotsLastFrame() const
+{
+	return ShotsLastFrame;
+}
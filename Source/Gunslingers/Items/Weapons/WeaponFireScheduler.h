@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "WeaponFireScheduler.generated.h"
+
+class AWeapon;
+
+/**
+* Fires every automatic weapon that is refiring, in one pass per frame. Each weapon keeps the exact
+* time of its next shot, so every shot that fell due since the last frame is fired with its own
+* timestamp and the rate matches ShotsPerMinute at any frame rate.
+*/
+UCLASS()
+class GUNSLINGERS_API AWeaponFireScheduler : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AWeaponFireScheduler();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	/* Scheduler of the world WorldContextObject is in, null when weapons refire on timers */
+	static AWeaponFireScheduler* Get(const UObject* WorldContextObject);
+
+	/* Keep firing Weapon every Interval seconds from NextShotTime, a weapon already scheduled keeps its time */
+	void StartFiring(AWeapon* Weapon, float NextShotTime, float Interval);
+
+	void StopFiring(AWeapon* Weapon);
+
+	bool IsFiring(const AWeapon* Weapon) const;
+
+	/* Shots fired in the last tick */
+	UFUNCTION(BlueprintCallable, Category = "Performance")
+	int32 GetShotsLastFrame() const;
+
+	/* After a hitch a weapon fires at most this many shots in one frame, the rest are dropped */
+	static const int32 MaxShotsPerFrame = 8;
+
+	/* Times of a weapon's shots due by Now, at most MaxShotsPerFrame, with NextShotTime moved past them.
+	   After a hitch the dropped shots are skipped and the next one is due Interval after Now. */
+	static int32 CollectDueShots(float& NextShotTime, float Interval, float Now, float OutShotTimes[MaxShotsPerFrame]);
+
+private:
+
+	/* Parallel arrays, one slot per firing weapon. Stopped weapons leave a null slot until the end of the tick. */
+	UPROPERTY(Transient)
+	TArray<AWeapon*> Weapons;
+
+	TArray<float> NextShotTimes;
+
+	TArray<float> Intervals;
+
+	int32 ShotsLastFrame;
+};
@@ -0,0 +1,168 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Gunslingers.h"
+#include "WeaponInstant.h"
+#include "GunslingersGameMode.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "GameFramework/PlayerState.h"
+
+DECLARE_CYCLE_STAT(TEXT("Hitbox Rewind"), STAT_HitboxRewind, STATGROUP_Game);
+
+
+AWeaponInstant::AWeaponInstant(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+#if WITH_EDITORONLY_DATA
+	HitDamage_DEPRECATED = 26.f;
+	DamageType_DEPRECATED = UDamageType::StaticClass();
+	WeaponRange_DEPRECATED = 15000.f;
+#endif
+}
+
+
+#if WITH_EDITORONLY_DATA
+void AWeaponInstant::MigrateDeprecatedTuning(UWeaponDefinition* NewDefinition) const
+{
+	Super::MigrateDeprecatedTuning(NewDefinition);
+
+	NewDefinition->HitDamage = HitDamage_DEPRECATED;
+	NewDefinition->DamageType = DamageType_DEPRECATED;
+	NewDefinition->WeaponRange = WeaponRange_DEPRECATED;
+	NewDefinition->DefaultImpactEffect = DefaultImpactEffect_DEPRECATED;
+	NewDefinition->SurfaceImpactEffects = SurfaceImpactEffects_DEPRECATED;
+}
+#endif
+
+
+void AWeaponInstant::FireWeapon(const FWeaponShot& Shot)
+{
+	/* The server traces a remote owner's shot itself, past the characters, and hits them where they were at Shot.Time */
+	const AGunslingersGameMode* const GM = GetWorld()->GetAuthGameMode<AGunslingersGameMode>();
+	const bool bRewind = Role == ROLE_Authority && !(MyPawn && MyPawn->IsLocallyControlled()) && GM && GM->bLagCompensateHits;
+
+	const FWeaponStats& Stats = GetStats();
+	FRandomStream SpreadStream(GetShotSeed(Shot.Sequence));
+
+	/* All pellets join the same batch of traces */
+	for (int32 Pellet = 0; Pellet < Stats.NumPellets; Pellet++)
+	{
+		const FVector ShootDir = Stats.SpreadHalfAngle > 0.f ? SpreadStream.VRandCone(Shot.Aim, Stats.SpreadHalfAngle) : FVector(Shot.Aim);
+		const FVector EndTrace = Shot.Origin + ShootDir * Definition->WeaponRange;
+
+		QueueWeaponTrace(Shot.Origin, EndTrace, FWeaponTraceDelegate::CreateUObject(this, &AWeaponInstant::OnShotTraced, Shot.Time, bRewind), bRewind);
+	}
+}
+
+
+void AWeaponInstant::OnShotTraced(const FHitResult& Impact, float ShotTime, bool bRewound)
+{
+	const FVector ShootDir = (Impact.TraceEnd - Impact.TraceStart).GetSafeNormal();
+
+	if (Impact.bBlockingHit && GetNetMode() != NM_DedicatedServer)
+	{
+		SpawnImpactEffects(Impact);
+	}
+
+	/* Client traces are only for effects, the server traces the streamed shot again */
+	if (Role < ROLE_Authority)
+	{
+		return;
+	}
+
+	FHitResult RewoundHit;
+	if (bRewound && FindRewoundHit(Impact, ShotTime, RewoundHit))
+	{
+		DealDamage(RewoundHit, ShootDir);
+	}
+	else
+	{
+		DealDamage(Impact, ShootDir);
+	}
+}
+
+
+void AWeaponInstant::DealDamage(const FHitResult& Impact, const FVector& ShootDir)
+{
+	AActor* const HitActor = Impact.GetActor();
+	if (HitActor == nullptr || MyPawn == nullptr)
+	{
+		return;
+	}
+
+	FPointDamageEvent PointDmg;
+	PointDmg.DamageTypeClass = Definition->DamageType;
+	PointDmg.HitInfo = Impact;
+	PointDmg.ShotDirection = ShootDir;
+	PointDmg.Damage = Definition->HitDamage;
+
+	HitActor->TakeDamage(PointDmg.Damage, PointDmg, MyPawn->Controller, this);
+}
+
+
+void AWeaponInstant::SpawnImpactEffects(const FHitResult& Impact)
+{
+	const EPhysicalSurface SurfaceType = UPhysicalMaterial::DetermineSurfaceType(Impact.PhysMaterial.Get());
+
+	AWeaponEffectsPool::SpawnImpact(this, Impact, Definition->FindImpactEffect(SurfaceType));
+}
+
+
+bool AWeaponInstant::FindRewoundHit(const FHitResult& Impact, float ShotTime, FHitResult& OutHit) const
+{
+	const AGunslingersGameMode* const GM = GetWorld()->GetAuthGameMode<AGunslingersGameMode>();
+	if (GM == nullptr)
+	{
+		return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_HitboxRewind);
+
+	/* Never trust a time from the future, or from further back than the shooter's own latency and
+	   the history allow. ExactPing is the round trip, as far as the shooter's view lags the server. */
+	const APlayerState* const ShooterState = MyPawn ? MyPawn->PlayerState : nullptr;
+	const float Latency = (ShooterState ? ShooterState->ExactPing * 0.001f : 0.f) + GM->RewindInterpolationSeconds + GM->RewindToleranceSeconds;
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	const float RewindTime = FHitboxHistory::ClampRewindTime(ShotTime, Now, FMath::Min(Latency, GM->MaxRewindSeconds));
+
+	/* The level does not move, a pellet stopped by it cannot hit anyone behind it */
+	const FVector ShotEnd = Impact.bBlockingHit ? Impact.ImpactPoint : Impact.TraceEnd;
+
+	APlayerCharacter* HitCharacter = nullptr;
+	FVector HitLocation = FVector::ZeroVector;
+	float NearestDistSquared = MAX_flt;
+
+	for (FConstPawnIterator It = GetWorld()->GetPawnIterator(); It; ++It)
+	{
+		APlayerCharacter* const Character = Cast<APlayerCharacter>(It->Get());
+		if (Character == nullptr || Character == MyPawn || Character->GetHitboxHistory().GetNumSamples() == 0)
+		{
+			continue;
+		}
+
+		FVector ShotPoint;
+		if (Character->GetHitboxHistory().SegmentHits(Impact.TraceStart, ShotEnd, RewindTime, GM->HitboxTolerance, &ShotPoint))
+		{
+			const float DistSquared = FVector::DistSquared(Impact.TraceStart, ShotPoint);
+			if (DistSquared < NearestDistSquared)
+			{
+				NearestDistSquared = DistSquared;
+				HitCharacter = Character;
+				HitLocation = ShotPoint;
+			}
+		}
+	}
+
+	if (HitCharacter == nullptr)
+	{
+		return false;
+	}
+
+	OutHit = FHitResult(HitCharacter, HitCharacter->GetMesh(), HitLocation, (Impact.TraceStart - Impact.TraceEnd).GetSafeNormal());
+	OutHit.bBlockingHit = true;
+	OutHit.TraceStart = Impact.TraceStart;
+	OutHit.TraceEnd = Impact.TraceEnd;
+	OutHit.Distance = FMath::Sqrt(NearestDistSquared);
+
+	return true;
+}
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Weapon.h"
+#include "WeaponInstant.generated.h"
+
+/**
+* Hitscan weapon: every shot is one trace per pellet around the aim, damage is applied by the server.
+* Damage, range, pellets and impact effects come from the Hitscan and Effects sections of the definition.
+*/
+UCLASS(ABSTRACT, Blueprintable)
+class AWeaponInstant : public AWeapon
+{
+	GENERATED_BODY()
+
+protected:
+
+	AWeaponInstant(const FObjectInitializer& ObjectInitializer);
+
+	virtual void FireWeapon(const FWeaponShot& Shot) override;
+
+#if WITH_EDITORONLY_DATA
+	virtual void MigrateDeprecatedTuning(UWeaponDefinition* NewDefinition) const override;
+
+	/* Hitscan tuning kept on the weapon before UWeaponDefinition, only loaded to be migrated */
+	UPROPERTY()
+		float HitDamage_DEPRECATED;
+
+	UPROPERTY()
+		TSubclassOf<UDamageType> DamageType_DEPRECATED;
+
+	UPROPERTY()
+		float WeaponRange_DEPRECATED;
+
+	UPROPERTY()
+		FImpactEffect DefaultImpactEffect_DEPRECATED;
+
+	UPROPERTY()
+		TArray<FImpactEffect> SurfaceImpactEffects_DEPRECATED;
+#endif
+
+	/* Result of one pellet's trace, a frame later when weapon traces are batched. ShotTime is
+	   the server time the shooter fired at, as estimated by the shooter. bRewound traces skipped
+	   the characters, they are checked against their hitboxes at ShotTime. */
+	void OnShotTraced(const FHitResult& Impact, float ShotTime, bool bRewound);
+
+	/* Server: nearest character whose hitboxes at ShotTime the traced pellet passed through before it hit the level */
+	bool FindRewoundHit(const FHitResult& Impact, float ShotTime, FHitResult& OutHit) const;
+
+	/* Server only */
+	void DealDamage(const FHitResult& Impact, const FVector& ShootDir);
+
+	/* Particles and decal for the physical material the shot hit */
+	void SpawnImpactEffects(const FHitResult& Impact);
+};
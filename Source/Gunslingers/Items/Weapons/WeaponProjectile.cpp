@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Gunslingers.h"
+#include "WeaponProjectile.h"
+#include "GunslingersProjectilePool.h"
+
+
+AWeaponProjectile::AWeaponProjectile(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+}
+
+
+void AWeaponProjectile::FireWeapon(const FWeaponShot& Shot)
+{
+	if (Definition->ProjectileClass == nullptr)
+	{
+		return;
+	}
+
+	const FWeaponStats& Stats = GetStats();
+	FRandomStream SpreadStream(GetShotSeed(Shot.Sequence));
+	const FVector MuzzleLocation = GetMuzzleLocation();
+
+	for (int32 Pellet = 0; Pellet < Stats.NumPellets; Pellet++)
+	{
+		const FVector ShootDir = Stats.SpreadHalfAngle > 0.f ? SpreadStream.VRandCone(Shot.Aim, Stats.SpreadHalfAngle) : FVector(Shot.Aim);
+
+		AGunslingersProjectilePool::SpawnProjectile(this, Definition->ProjectileClass, MuzzleLocation, ShootDir.Rotation(), this, Instigator);
+	}
+}
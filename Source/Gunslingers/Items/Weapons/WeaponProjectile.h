@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Weapon.h"
+#include "WeaponProjectile.generated.h"
+
+/**
+* Projectile weapon: every shot launches one ProjectileClass from the definition per pellet, spread around
+* the aim like hitscan pellets. The owner and the server each launch their own, through the projectile pool.
+*/
+UCLASS(ABSTRACT, Blueprintable)
+class AWeaponProjectile : public AWeapon
+{
+	GENERATED_BODY()
+
+protected:
+
+	AWeaponProjectile(const FObjectInitializer& ObjectInitializer);
+
+	virtual void FireWeapon(const FWeaponShot& Shot) override;
+};
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+/* Everything the weapon state logic reads, gathered by the weapon from itself and its pawn */
+struct FWeaponStateInputs
+{
+	bool bEquipped;
+	bool bPendingEquip;
+	bool bWantsToFire;
+	bool bPendingReload;
+	bool bPawnCanFire;
+	bool bPawnCanReload;
+	int32 Ammo;
+	int32 AmmoInClip;
+	int32 MaxAmmoPerClip;
+};
+
+/**
+* Firing, reloading and ammo rules of a weapon with no engine dependencies: no world, no timers,
+* no pawn. AWeapon gathers FWeaponStateInputs, asks for the next state and runs the side effects
+* the transition table lists. Kept header only so it can be built on its own.
+*/
+class FWeaponStateMachine
+{
+public:
+
+	/* Same order as EWeaponState */
+	enum class EState : uint8
+	{
+		Idle,
+		Firing,
+		Equipping,
+		Reloading,
+		Count
+	};
+
+	/* Side effects of a transition, as bit flags */
+	enum ETransitionEffect : uint8
+	{
+		None = 0,
+		/* Leaving Firing: stop the refire and the firing FX */
+		BurstFinished = 1 << 0,
+		/* Entering Firing: fire the first shot or schedule it */
+		BurstStarted = 1 << 1
+	};
+
+	/* Effects of going From -> To, looked up in the compile time table */
+	static constexpr uint8 GetTransitionEffects(EState From, EState To);
+
+	static FORCEINLINE bool CanFire(EState Current, const FWeaponStateInputs& Inputs)
+	{
+		const bool bStateOK = Current == EState::Idle || Current == EState::Firing;
+		return Inputs.bPawnCanFire && bStateOK && !Inputs.bPendingReload;
+	}
+
+	static FORCEINLINE bool CanReload(EState Current, const FWeaponStateInputs& Inputs)
+	{
+		const bool bGotAmmo = Inputs.AmmoInClip < Inputs.MaxAmmoPerClip && Inputs.Ammo - Inputs.AmmoInClip > 0;
+		const bool bStateOKToReload = Current == EState::Idle || Current == EState::Firing;
+		return Inputs.bPawnCanReload && bGotAmmo && bStateOKToReload;
+	}
+
+	/* State the weapon should be in. A reload that cannot start yet keeps the current state. */
+	static FORCEINLINE EState DetermineState(EState Current, const FWeaponStateInputs& Inputs)
+	{
+		if (Inputs.bEquipped)
+		{
+			if (Inputs.bPendingReload)
+			{
+				return CanReload(Current, Inputs) ? EState::Reloading : Current;
+			}
+			if (Inputs.bWantsToFire && CanFire(Current, Inputs))
+			{
+				return EState::Firing;
+			}
+			return EState::Idle;
+		}
+
+		return Inputs.bPendingEquip ? EState::Equipping : EState::Idle;
+	}
+
+	static FORCEINLINE void UseAmmo(int32& Ammo, int32& AmmoInClip)
+	{
+		AmmoInClip--;
+		Ammo--;
+	}
+
+	/* Rounds a finished reload moves into the clip */
+	static FORCEINLINE int32 GetReloadAmount(int32 Ammo, int32 AmmoInClip, int32 MaxAmmoPerClip)
+	{
+		const int32 ClipDelta = MaxAmmoPerClip - AmmoInClip < Ammo - AmmoInClip ? MaxAmmoPerClip - AmmoInClip : Ammo - AmmoInClip;
+		return ClipDelta > 0 ? ClipDelta : 0;
+	}
+
+};
+
+namespace WeaponStateMachine
+{
+	/* [From][To], only entering and leaving Firing have side effects */
+	constexpr uint8 TransitionTable[(uint8)FWeaponStateMachine::EState::Count][(uint8)FWeaponStateMachine::EState::Count] =
+	{
+		/* From Idle */      { FWeaponStateMachine::None, FWeaponStateMachine::BurstStarted, FWeaponStateMachine::None, FWeaponStateMachine::None },
+		/* From Firing */    { FWeaponStateMachine::BurstFinished, FWeaponStateMachine::None, FWeaponStateMachine::BurstFinished, FWeaponStateMachine::BurstFinished },
+		/* From Equipping */ { FWeaponStateMachine::None, FWeaponStateMachine::BurstStarted, FWeaponStateMachine::None, FWeaponStateMachine::None },
+		/* From Reloading */ { FWeaponStateMachine::None, FWeaponStateMachine::BurstStarted, FWeaponStateMachine::None, FWeaponStateMachine::None },
+	};
+}
+
+constexpr uint8 FWeaponStateMachine::GetTransitionEffects(EState From, EState To)
+{
+	return WeaponStateMachine::TransitionTable[(uint8)From][(uint8)To];
+}
+
+static_assert(FWeaponStateMachine::GetTransitionEffects(FWeaponStateMachine::EState::Firing, FWeaponStateMachine::EState::Firing) == FWeaponStateMachine::None, "Staying in Firing must not restart the burst");
+static_assert(FWeaponStateMachine::GetTransitionEffects(FWeaponStateMachine::EState::Firing, FWeaponStateMachine::EState::Reloading) == FWeaponStateMachine::BurstFinished, "Reloading while firing must end the burst");
@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Gunslingers.h"
+#include "WeaponTraceManager.h"
+#include "GunslingersGameState.h"
+#include "Characters/PlayerCharacter.h"
+
+DECLARE_STATS_GROUP(TEXT("WeaponTraces"), STATGROUP_WeaponTraces, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Submit Traces"), STAT_SubmitWeaponTraces, STATGROUP_WeaponTraces);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Traces Per Frame"), STAT_WeaponTracesPerFrame, STATGROUP_WeaponTraces);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Traces In Flight"), STAT_WeaponTracesInFlight, STATGROUP_WeaponTraces);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Trace Latency (ms)"), STAT_WeaponTraceLatency, STATGROUP_WeaponTraces);
+
+
+AWeaponTraceManager::AWeaponTraceManager()
+{
+	/* After the timers, so shots from refiring automatic weapons are in the same batch */
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	NextTraceId = 1;
+	TracesLastFrame = 0;
+	NumResults = 0;
+	ResultLatencySeconds = 0.0;
+	LatencyLastFrameMs = 0.f;
+
+	TraceDelegate.BindUObject(this, &AWeaponTraceManager::OnTraceDone);
+}
+
+void AWeaponTraceManager::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	SCOPE_CYCLE_COUNTER(STAT_SubmitWeaponTraces);
+
+	UWorld* const World = GetWorld();
+	for (FWeaponTraceRequest& Request : QueuedTraces)
+	{
+		const FCollisionQueryParams TraceParams = MakeTraceParams(World, Request.IgnoredActor.Get(), Request.bIgnoreCharacters);
+
+		const uint32 TraceId = NextTraceId++;
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Request.Start, Request.End, COLLISION_WEAPON, TraceParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, TraceId);
+		PendingTraces.Add(TraceId, MoveTemp(Request));
+	}
+
+	TracesLastFrame = QueuedTraces.Num();
+	QueuedTraces.Reset();
+
+	LatencyLastFrameMs = NumResults > 0 ? (float)(ResultLatencySeconds / NumResults * 1000.0) : 0.f;
+	NumResults = 0;
+	ResultLatencySeconds = 0.0;
+
+	SET_DWORD_STAT(STAT_WeaponTracesPerFrame, TracesLastFrame);
+	SET_DWORD_STAT(STAT_WeaponTracesInFlight, PendingTraces.Num());
+	SET_FLOAT_STAT(STAT_WeaponTraceLatency, LatencyLastFrameMs);
+}
+
+AWeaponTraceManager* AWeaponTraceManager::Get(const UObject* WorldContextObject)
+{
+	const UWorld* const World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	const AGunslingersGameState* const GS = World ? World->GetGameState<AGunslingersGameState>() : nullptr;
+
+	return GS ? GS->GetWeaponTraceManager() : nullptr;
+}
+
+void AWeaponTraceManager::QueueTrace(const FVector& Start, const FVector& End, const AActor* IgnoredActor, const FWeaponTraceDelegate& OnComplete, bool bIgnoreCharacters)
+{
+	FWeaponTraceRequest Request;
+	Request.Start = Start;
+	Request.End = End;
+	Request.IgnoredActor = IgnoredActor;
+	Request.bIgnoreCharacters = bIgnoreCharacters;
+	Request.OnComplete = OnComplete;
+	Request.QueueTime = FPlatformTime::Seconds();
+
+	QueuedTraces.Add(MoveTemp(Request));
+}
+
+FCollisionQueryParams AWeaponTraceManager::MakeTraceParams(const UWorld* World, const AActor* IgnoredActor, bool bIgnoreCharacters)
+{
+	FCollisionQueryParams TraceParams(TEXT("WeaponTrace"), true, IgnoredActor);
+	TraceParams.bTraceAsyncScene = true;
+	TraceParams.bReturnPhysicalMaterial = true;
+
+	if (bIgnoreCharacters)
+	{
+		for (FConstPawnIterator It = World->GetPawnIterator(); It; ++It)
+		{
+			const APlayerCharacter* const Character = Cast<APlayerCharacter>(It->Get());
+			if (Character)
+			{
+				TraceParams.AddIgnoredActor(Character);
+			}
+		}
+	}
+
+	return TraceParams;
+}
+
+int32 AWeaponTraceManager::GetTracesLastFrame() const
+{
+	return TracesLastFrame;
+}
+
+float AWeaponTraceManager::GetLatencyLastFrameMs() const
+{
+	return LatencyLastFrameMs;
+}
+
+void AWeaponTraceManager::OnTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	FWeaponTraceRequest Request;
+	if (!PendingTraces.RemoveAndCopyValue(Datum.UserData, Request))
+	{
+		return;
+	}
+
+	NumResults++;
+	ResultLatencySeconds += FPlatformTime::Seconds() - Request.QueueTime;
+
+	/* A single trace returns at most one blocking hit, a miss still reports where the shot ended */
+	FHitResult Hit(ForceInit);
+	if (Datum.OutHits.Num() > 0)
+	{
+		Hit = Datum.OutHits[0];
+	}
+	else
+	{
+		Hit.TraceStart = Datum.Start;
+		Hit.TraceEnd = Datum.End;
+	}
+
+	/* Weapons destroyed while their trace was in flight are unbound here */
+	Request.OnComplete.ExecuteIfBound(Hit);
+}
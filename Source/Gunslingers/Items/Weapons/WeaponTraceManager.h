@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "WeaponTraceManager.generated.h"
+
+DECLARE_DELEGATE_OneParam(FWeaponTraceDelegate, const FHitResult&);
+
+/* A shot trace waiting for submission or for its result */
+struct FWeaponTraceRequest
+{
+	FVector Start;
+	FVector End;
+	/* The shooter, never hit by its own shot */
+	TWeakObjectPtr<const AActor> IgnoredActor;
+	/* Pass through player characters, for shots checked against their hitbox history instead */
+	bool bIgnoreCharacters;
+	FWeaponTraceDelegate OnComplete;
+	double QueueTime;
+};
+
+/**
+* Collects the shot traces of every weapon during the frame and submits them together as
+* asynchronous traces once all weapons have fired. Physics runs them off the game thread and the
+* results come back to each weapon's callback at the start of the next frame.
+*/
+UCLASS()
+class GUNSLINGERS_API AWeaponTraceManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AWeaponTraceManager();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	/* Manager of the world WorldContextObject is in, null when traces are not batched */
+	static AWeaponTraceManager* Get(const UObject* WorldContextObject);
+
+	/* Trace on COLLISION_WEAPON with physical materials, OnComplete runs next frame */
+	void QueueTrace(const FVector& Start, const FVector& End, const AActor* IgnoredActor, const FWeaponTraceDelegate& OnComplete, bool bIgnoreCharacters = false);
+
+	/* Query params of a weapon trace, shared with the synchronous fallback */
+	static FCollisionQueryParams MakeTraceParams(const UWorld* World, const AActor* IgnoredActor, bool bIgnoreCharacters);
+
+	/* Traces submitted in the last batch */
+	UFUNCTION(BlueprintCallable, Category = "Performance")
+	int32 GetTracesLastFrame() const;
+
+	/* Time from queueing to the callback, averaged over the last frame's results */
+	UFUNCTION(BlueprintCallable, Category = "Performance")
+	float GetLatencyLastFrameMs() const;
+
+private:
+
+	void OnTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	/* Queued this frame, not yet submitted */
+	TArray<FWeaponTraceRequest> QueuedTraces;
+
+	/* Submitted and waiting for physics, by the user data passed with the trace */
+	TMap<uint32, FWeaponTraceRequest> PendingTraces;
+
+	uint32 NextTraceId;
+
+	FTraceDelegate TraceDelegate;
+
+	int32 TracesLastFrame;
+
+	/* Results delivered since the last batch and their summed latency */
+	int32 NumResults;
+
+	double ResultLatencySeconds;
+
+	float LatencyLastFrameMs;
+};
@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Gunslingers.h"
+#include "LevelLayoutCache.h"
+
+
+FLevelLayoutView::FLevelLayoutView()
+	: Header(nullptr),
+	TileCells(nullptr),
+	WallCells(nullptr),
+	WallRuns(nullptr),
+	TileRotations(nullptr)
+{
+}
+
+bool FLevelLayoutView::Initialize(const uint8* Data, int64 DataSize)
+{
+	*this = FLevelLayoutView();
+
+	if (Data == nullptr || DataSize < (int64)sizeof(FLevelLayoutFileHeader))
+	{
+		return false;
+	}
+
+	const FLevelLayoutFileHeader* FileHeader = reinterpret_cast<const FLevelLayoutFileHeader*>(Data);
+	if (FileHeader->Magic != FLevelLayoutCache::FileMagic ||
+		FileHeader->FileVersion != FLevelLayoutCache::FileVersion ||
+		FileHeader->NumTileCells < 0 || FileHeader->NumWallCells < 0 || FileHeader->NumWallRuns < 0)
+	{
+		return false;
+	}
+
+	const int64 TileCellsOffset = sizeof(FLevelLayoutFileHeader);
+	const int64 WallCellsOffset = TileCellsOffset + (int64)FileHeader->NumTileCells * sizeof(FIntPoint);
+	const int64 WallRunsOffset = WallCellsOffset + (int64)FileHeader->NumWallCells * sizeof(FIntPoint);
+	const int64 RotationsOffset = WallRunsOffset + (int64)FileHeader->NumWallRuns * sizeof(FLevelLayoutFileRun);
+	const int64 ExpectedSize = RotationsOffset + FileHeader->NumTileCells;
+
+	if (DataSize != ExpectedSize)
+	{
+		return false;
+	}
+
+	Header = FileHeader;
+	TileCells = reinterpret_cast<const FIntPoint*>(Data + TileCellsOffset);
+	WallCells = reinterpret_cast<const FIntPoint*>(Data + WallCellsOffset);
+	WallRuns = reinterpret_cast<const FLevelLayoutFileRun*>(Data + WallRunsOffset);
+	TileRotations = Data + RotationsOffset;
+
+	return true;
+}
+
+bool FLevelLayoutView::IsValid() const
+{
+	return Header != nullptr;
+}
+
+bool FLevelLayoutView::CopyTo(FLevelLayout& OutLayout) const
+{
+	OutLayout.Reset();
+
+	if (!IsValid())
+	{
+		return false;
+	}
+
+	OutLayout.TileCells.Append(TileCells, Header->NumTileCells);
+	OutLayout.TileRotations.Append(TileRotations, Header->NumTileCells);
+	OutLayout.WallCells.Append(WallCells, Header->NumWallCells);
+
+	OutLayout.WallRuns.Reserve(Header->NumWallRuns);
+	for (int32 i = 0; i < Header->NumWallRuns; i++)
+	{
+		OutLayout.WallRuns.Add({ FIntPoint(WallRuns[i].X, WallRuns[i].Y), WallRuns[i].Length, WallRuns[i].bAlongX != 0 });
+	}
+
+	OutLayout.AllocatedCells.Append(OutLayout.TileCells);
+	OutLayout.Checksum = Header->Checksum;
+	OutLayout.MaxWalkRetries = Header->MaxWalkRetries;
+
+	/* The generator never places two tiles in one cell, so the set must hold every tile */
+	if (OutLayout.AllocatedCells.Num() != OutLayout.TileCells.Num())
+	{
+		return false;
+	}
+
+	for (const uint8 Rotation : OutLayout.TileRotations)
+	{
+		if (Rotation > 3)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+FString FLevelLayoutCache::GetCachePath(int32 Seed, int32 NumberOfTiles)
+{
+	return FPaths::Combine(*FPaths::GameSavedDir(), TEXT("LayoutCache"), *FString::Printf(TEXT("Layout_%d_%d_v%d.bin"), Seed, NumberOfTiles, FLevelLayoutGenerator::Version));
+}
+
+void FLevelLayoutCache::Serialize(const FLevelLayout& Layout, int32 Seed, int32 NumberOfTiles, TArray<uint8>& OutData)
+{
+	FLevelLayoutFileHeader Header;
+	Header.Magic = FileMagic;
+	Header.FileVersion = FileVersion;
+	Header.GeneratorVersion = FLevelLayoutGenerator::Version;
+	Header.Seed = Seed;
+	Header.NumberOfTiles = NumberOfTiles;
+	Header.Checksum = Layout.Checksum;
+	Header.MaxWalkRetries = Layout.MaxWalkRetries;
+	Header.NumTileCells = Layout.TileCells.Num();
+	Header.NumWallCells = Layout.WallCells.Num();
+	Header.NumWallRuns = Layout.WallRuns.Num();
+
+	OutData.Reset(sizeof(Header) + Layout.TileCells.Num() * sizeof(FIntPoint) + Layout.WallCells.Num() * sizeof(FIntPoint) + Layout.WallRuns.Num() * sizeof(FLevelLayoutFileRun) + Layout.TileRotations.Num());
+
+	OutData.Append(reinterpret_cast<const uint8*>(&Header), sizeof(Header));
+	OutData.Append(reinterpret_cast<const uint8*>(Layout.TileCells.GetData()), Layout.TileCells.Num() * sizeof(FIntPoint));
+	OutData.Append(reinterpret_cast<const uint8*>(Layout.WallCells.GetData()), Layout.WallCells.Num() * sizeof(FIntPoint));
+
+	for (const FWallRun& Run : Layout.WallRuns)
+	{
+		const FLevelLayoutFileRun FileRun = { Run.Start.X, Run.Start.Y, Run.Length, Run.bAlongX ? 1 : 0 };
+		OutData.Append(reinterpret_cast<const uint8*>(&FileRun), sizeof(FileRun));
+	}
+
+	OutData.Append(Layout.TileRotations.GetData(), Layout.TileRotations.Num());
+}
+
+bool FLevelLayoutCache::Deserialize(const TArray<uint8>& Data, int32 Seed, int32 NumberOfTiles, FLevelLayout& OutLayout)
+{
+	FLevelLayoutView View;
+	if (!View.Initialize(Data.GetData(), Data.Num()))
+	{
+		return false;
+	}
+
+	/* Same name but built from other parameters, treat as a miss */
+	if (View.Header->Seed != Seed || View.Header->NumberOfTiles != NumberOfTiles || View.Header->GeneratorVersion != FLevelLayoutGenerator::Version)
+	{
+		return false;
+	}
+
+	if (!View.CopyTo(OutLayout) || OutLayout.ComputeChecksum() != OutLayout.Checksum)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Cached layout for seed %d is corrupt, regenerating."), Seed);
+		OutLayout.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool FLevelLayoutCache::Save(const FLevelLayout& Layout, int32 Seed, int32 NumberOfTiles)
+{
+	TArray<uint8> Data;
+	Serialize(Layout, Seed, NumberOfTiles, Data);
+
+	return FFileHelper::SaveArrayToFile(Data, *GetCachePath(Seed, NumberOfTiles));
+}
+
+bool FLevelLayoutCache::Load(int32 Seed, int32 NumberOfTiles, FLevelLayout& OutLayout)
+{
+	/* One read of the whole file, the view then works on it in place */
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *GetCachePath(Seed, NumberOfTiles), FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	return Deserialize(Data, Seed, NumberOfTiles, OutLayout);
+}
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "LevelLayoutGenerator.h"
+
+/**
+* Binary layout file. Little endian, fixed size records, read in place without per element parsing:
+*
+*   FLevelLayoutFileHeader
+*   FIntPoint              TileCells[NumTileCells]
+*   FIntPoint              WallCells[NumWallCells]
+*   FLevelLayoutFileRun    WallRuns[NumWallRuns]
+*   uint8                  TileRotations[NumTileCells]
+*/
+struct FLevelLayoutFileHeader
+{
+	uint32 Magic;
+	uint32 FileVersion;
+	int32 GeneratorVersion;
+	int32 Seed;
+	int32 NumberOfTiles;
+	uint32 Checksum;
+	int32 MaxWalkRetries;
+	int32 NumTileCells;
+	int32 NumWallCells;
+	int32 NumWallRuns;
+};
+
+struct FLevelLayoutFileRun
+{
+	int32 X;
+	int32 Y;
+	int32 Length;
+	int32 bAlongX;
+};
+
+/**
+* Read-only view of a layout file held in memory. Points straight into the file data,
+* which must outlive the view.
+*/
+struct FLevelLayoutView
+{
+	const FLevelLayoutFileHeader* Header;
+	const FIntPoint* TileCells;
+	const FIntPoint* WallCells;
+	const FLevelLayoutFileRun* WallRuns;
+	const uint8* TileRotations;
+
+	FLevelLayoutView();
+
+	/* Validate magic, version and sizes. Returns false and leaves the view empty on any mismatch. */
+	bool Initialize(const uint8* Data, int64 DataSize);
+
+	bool IsValid() const;
+
+	/* Bulk copy the arrays into OutLayout and rebuild its occupancy set. Returns false when the tiles
+	   cannot have come from the generator: a cell listed twice or a rotation past a quarter turn count. */
+	bool CopyTo(FLevelLayout& OutLayout) const;
+};
+
+/**
+* Generated layouts saved on disk, keyed by seed, tile count and generator version,
+* so fixed playlist seeds skip the random walk after their first match.
+*/
+class GUNSLINGERS_API FLevelLayoutCache
+{
+public:
+
+	static const uint32 FileMagic = 0x594C5347; // 'GSLY'
+
+	/* 2: the checksum also covers walls */
+	static const uint32 FileVersion = 2;
+
+	static FString GetCachePath(int32 Seed, int32 NumberOfTiles);
+
+	static void Serialize(const FLevelLayout& Layout, int32 Seed, int32 NumberOfTiles, TArray<uint8>& OutData);
+
+	static bool Deserialize(const TArray<uint8>& Data, int32 Seed, int32 NumberOfTiles, FLevelLayout& OutLayout);
+
+	static bool Save(const FLevelLayout& Layout, int32 Seed, int32 NumberOfTiles);
+
+	/* Returns false when no valid layout for these parameters is cached */
+	static bool Load(int32 Seed, int32 NumberOfTiles, FLevelLayout& OutLayout);
+};
@@ -0,0 +1,204 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Gunslingers.h"
+#include "LevelLayoutGenerator.h"
+#include "LevelLayoutCache.h"
+
+
+const FIntPoint FLevelLayout::NeighborOffsets[4] = { FIntPoint(1, 0), FIntPoint(-1, 0), FIntPoint(0, 1), FIntPoint(0, -1) };
+
+FLevelLayout::FLevelLayout()
+	: Checksum(0),
+	MaxWalkRetries(0)
+{
+}
+
+void FLevelLayout::Reset()
+{
+	TileCells.Reset();
+	TileRotations.Reset();
+	WallCells.Reset();
+	WallRuns.Reset();
+	AllocatedCells.Reset();
+	Checksum = 0;
+	MaxWalkRetries = 0;
+}
+
+bool FLevelLayout::IsCellAllocated(const FIntPoint& Cell) const
+{
+	return AllocatedCells.Contains(Cell);
+}
+
+int32 FLevelLayout::CountAllocatedNeighbors(const FIntPoint& Cell) const
+{
+	int32 Count = 0;
+	for (const FIntPoint& Offset : NeighborOffsets) {
+		if (IsCellAllocated(Cell + Offset)) { Count++; }
+	}
+
+	return Count;
+}
+
+uint32 FLevelLayout::ComputeChecksum() const
+{
+	uint32 Crc = 0;
+	for (int32 i = 0; i < TileCells.Num(); i++) {
+		const int32 Rotation = TileRotations[i];
+		Crc = FCrc::MemCrc32(&TileCells[i], sizeof(FIntPoint), Crc);
+		Crc = FCrc::MemCrc32(&Rotation, sizeof(Rotation), Crc);
+	}
+
+	Crc = FCrc::MemCrc32(WallCells.GetData(), WallCells.Num() * sizeof(FIntPoint), Crc);
+
+	/* Field by field, FWallRun has padding after bAlongX */
+	for (const FWallRun& Run : WallRuns) {
+		const int32 RunData[4] = { Run.Start.X, Run.Start.Y, Run.Length, Run.bAlongX ? 1 : 0 };
+		Crc = FCrc::MemCrc32(RunData, sizeof(RunData), Crc);
+	}
+
+	return Crc;
+}
+
+SIZE_T FLevelLayout::GetAllocatedSize() const
+{
+	return TileCells.GetAllocatedSize() + TileRotations.GetAllocatedSize() + WallCells.GetAllocatedSize() + WallRuns.GetAllocatedSize() + AllocatedCells.GetAllocatedSize();
+}
+
+
+FLevelLayoutGenerator::FLevelLayoutGenerator(int32 InSeed, int32 InNumberOfTiles)
+	: Seed(InSeed),
+	NumberOfTiles(InNumberOfTiles)
+{
+}
+
+void FLevelLayoutGenerator::Generate(FLevelLayout& OutLayout) const
+{
+	OutLayout.Reset();
+
+	LayoutLevelTiles(OutLayout);
+	LayoutLevelWalls(OutLayout);
+	MergeWallRuns(OutLayout);
+
+	OutLayout.Checksum = OutLayout.ComputeChecksum();
+}
+
+TFuture<FLevelLayoutPtr> FLevelLayoutGenerator::GenerateAsync(int32 Seed, int32 NumberOfTiles, bool bUseCache)
+{
+	/* Captures only values, the task never touches the world or the caller */
+	return Async<FLevelLayoutPtr>(EAsyncExecution::ThreadPool, [Seed, NumberOfTiles, bUseCache]()
+	{
+		TSharedPtr<FLevelLayout, ESPMode::ThreadSafe> NewLayout = MakeShareable(new FLevelLayout());
+
+		if (!bUseCache || !FLevelLayoutCache::Load(Seed, NumberOfTiles, *NewLayout))
+		{
+			FLevelLayoutGenerator(Seed, NumberOfTiles).Generate(*NewLayout);
+
+			if (bUseCache)
+			{
+				FLevelLayoutCache::Save(*NewLayout, Seed, NumberOfTiles);
+			}
+		}
+
+		return FLevelLayoutPtr(NewLayout);
+	});
+}
+
+void FLevelLayoutGenerator::LayoutLevelTiles(FLevelLayout& OutLayout) const
+{
+	FWalkState Walk = { FRandomStream(Seed), FIntPoint::ZeroValue, 0, 0 };
+
+	OutLayout.TileCells.Reserve(NumberOfTiles);
+	OutLayout.TileRotations.Reserve(NumberOfTiles);
+	OutLayout.AllocatedCells.Reserve(NumberOfTiles);
+
+	for (int32 i = 0; i < NumberOfTiles; i++) {
+		OutLayout.TileCells.Add(Walk.Cell);
+		OutLayout.TileRotations.Add((uint8)Walk.Rotation);
+		OutLayout.AllocatedCells.Add(Walk.Cell);
+
+		SetRandomTransform(Walk, OutLayout);
+		OutLayout.MaxWalkRetries = FMath::Max(OutLayout.MaxWalkRetries, Walk.Retries);
+	}
+}
+
+void FLevelLayoutGenerator::LayoutLevelWalls(FLevelLayout& OutLayout)
+{
+	/* Two tiles can border the same empty cell, only place one wall there */
+	TSet<FIntPoint> WallCellSet;
+	WallCellSet.Reserve(OutLayout.TileCells.Num() * 2);
+
+	for (const FIntPoint& AllocatedCell : OutLayout.TileCells) {
+		for (const FIntPoint& Offset : FLevelLayout::NeighborOffsets) {
+			const FIntPoint WallCell = AllocatedCell + Offset;
+			if (OutLayout.IsCellAllocated(WallCell) == false && !WallCellSet.Contains(WallCell)) {
+				WallCellSet.Add(WallCell);
+				OutLayout.WallCells.Add(WallCell);
+			}
+		}
+	}
+}
+
+void FLevelLayoutGenerator::MergeWallRuns(FLevelLayout& OutLayout)
+{
+	TSet<FIntPoint> WallCellSet;
+	WallCellSet.Append(OutLayout.WallCells);
+	TSet<FIntPoint> CoveredCells;
+	CoveredCells.Reserve(OutLayout.WallCells.Num());
+
+	/* Runs along X, only kept when they merge at least two cells */
+	for (const FIntPoint& Start : OutLayout.WallCells) {
+		if (WallCellSet.Contains(Start - FIntPoint(1, 0))) { continue; }
+
+		int32 Length = 1;
+		while (WallCellSet.Contains(Start + FIntPoint(Length, 0))) { Length++; }
+
+		if (Length >= 2) {
+			OutLayout.WallRuns.Add({ Start, Length, true });
+			for (int32 i = 0; i < Length; i++) { CoveredCells.Add(Start + FIntPoint(i, 0)); }
+		}
+	}
+
+	/* Everything left goes into runs along Y, single cells included */
+	auto IsOpenWallCell = [&](const FIntPoint& Cell) { return WallCellSet.Contains(Cell) && !CoveredCells.Contains(Cell); };
+
+	int32 NumCoveredAlongY = 0;
+	for (const FIntPoint& Start : OutLayout.WallCells) {
+		if (!IsOpenWallCell(Start) || IsOpenWallCell(Start - FIntPoint(0, 1))) { continue; }
+
+		int32 Length = 1;
+		while (IsOpenWallCell(Start + FIntPoint(0, Length))) { Length++; }
+
+		OutLayout.WallRuns.Add({ Start, Length, false });
+		NumCoveredAlongY += Length;
+	}
+
+	/* Every boundary cell must end up in exactly one run */
+	ensureMsgf(CoveredCells.Num() + NumCoveredAlongY == OutLayout.WallCells.Num(),
+		TEXT("Wall runs cover %d cells, the arena boundary has %d."), CoveredCells.Num() + NumCoveredAlongY, OutLayout.WallCells.Num());
+}
+
+void FLevelLayoutGenerator::SetRandomTransform(FWalkState& Walk, const FLevelLayout& Layout)
+{
+	const bool IsXDirection = Walk.Stream.RandRange(0, 1) == 1;
+	const bool IsPositive = Walk.Stream.RandRange(0, 1) == 1;
+	Walk.Rotation = Walk.Stream.RandRange(0, 3);
+
+	OffsetLocation(Walk.Cell, IsXDirection, IsPositive);
+
+	/* Keep walking the same way until a free cell is found */
+	Walk.Retries = 0;
+	while (Layout.IsCellAllocated(Walk.Cell)) {
+		OffsetLocation(Walk.Cell, IsXDirection, IsPositive);
+		Walk.Retries++;
+	}
+}
+
+void FLevelLayoutGenerator::OffsetLocation(FIntPoint& Cell, bool DirectionX, bool Positive)
+{
+	if (DirectionX == true) {
+		Cell.X += Positive ? 1 : -1;
+	}
+	else {
+		Cell.Y += Positive ? 1 : -1;
+	}
+}
@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Async/Async.h"
+
+/**
+* A straight line of wall cells drawn as one segment.
+*/
+struct FWallRun
+{
+	FIntPoint Start;
+	int32 Length;
+	bool bAlongX;
+};
+
+/**
+* Output of the arena generator, in grid cells. Tile cells are in placement order.
+*/
+struct GUNSLINGERS_API FLevelLayout
+{
+	TArray<FIntPoint> TileCells;
+
+	/* Yaw of each tile in quarter turns, parallel to TileCells */
+	TArray<uint8> TileRotations;
+
+	/* Empty cells bordering the arena, each listed once */
+	TArray<FIntPoint> WallCells;
+
+	/* WallCells merged into straight runs, every wall cell is in exactly one run */
+	TArray<FWallRun> WallRuns;
+
+	/* Every tile cell, for O(1) occupancy queries */
+	TSet<FIntPoint> AllocatedCells;
+
+	/* CRC of the tiles and walls, compared between server and clients and checked on cached layouts */
+	uint32 Checksum;
+
+	/* Most cells the random walk had to skip to find a free one for a single tile */
+	int32 MaxWalkRetries;
+
+	FLevelLayout();
+
+	void Reset();
+
+	bool IsCellAllocated(const FIntPoint& Cell) const;
+
+	/* Number of the four edge neighbours of Cell that hold a tile */
+	int32 CountAllocatedNeighbors(const FIntPoint& Cell) const;
+
+	/* CRC of the tile cells and rotations in placement order, then the wall cells and runs */
+	uint32 ComputeChecksum() const;
+
+	/* Heap memory held by the layout */
+	SIZE_T GetAllocatedSize() const;
+
+	/* Edge neighbours of a grid cell: +X, -X, +Y, -Y */
+	static const FIntPoint NeighborOffsets[4];
+};
+
+/* Finished layouts are immutable and may be shared between threads */
+typedef TSharedPtr<const FLevelLayout, ESPMode::ThreadSafe> FLevelLayoutPtr;
+
+/**
+* The arena random walk. Has no world or actor dependencies and keeps no state between calls,
+* so it runs the same in game, on clients, in commandlets and on worker threads.
+*/
+class GUNSLINGERS_API FLevelLayoutGenerator
+{
+public:
+	FLevelLayoutGenerator(int32 InSeed, int32 InNumberOfTiles);
+
+	/* Bump whenever the walk or the wall pass changes, cached layouts of other versions are ignored */
+	static const int32 Version = 2;
+
+	void Generate(FLevelLayout& OutLayout) const;
+
+	/* Generate on the thread pool, or load from the layout cache when bUseCache is set.
+	   Any number can run at once, e.g. to try several candidate seeds. */
+	static TFuture<FLevelLayoutPtr> GenerateAsync(int32 Seed, int32 NumberOfTiles, bool bUseCache);
+
+private:
+
+	/* Cursor of the random walk, local to one Generate call */
+	struct FWalkState
+	{
+		/* All layout randomness comes from here, never from FMath::Rand* */
+		FRandomStream Stream;
+
+		/* Grid cell the walk is currently on */
+		FIntPoint Cell;
+
+		int32 Rotation;
+
+		/* Cells skipped to find a free one for the last tile */
+		int32 Retries;
+	};
+
+	void LayoutLevelTiles(FLevelLayout& OutLayout) const;
+
+	static void LayoutLevelWalls(FLevelLayout& OutLayout);
+
+	/* Greedy pass: long runs along X first, the remaining cells become runs along Y */
+	static void MergeWallRuns(FLevelLayout& OutLayout);
+
+	/* Pick a direction and rotation, then walk that way to the next free cell */
+	static void SetRandomTransform(FWalkState& Walk, const FLevelLayout& Layout);
+
+	static void OffsetLocation(FIntPoint& Cell, bool DirectionX, bool Positive);
+
+	const int32 Seed;
+
+	const int32 NumberOfTiles;
+};
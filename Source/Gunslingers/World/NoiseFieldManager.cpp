@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Gunslingers.h"
+#include "NoiseFieldManager.h"
+#include "GunslingersGameMode.h"
+#include "GunslingersGameState.h"
+
+DECLARE_CYCLE_STAT(TEXT("Sample Noise Field"), STAT_SampleNoiseField, STATGROUP_Game);
+
+
+ANoiseFieldManager::ANoiseFieldManager()
+{
+	/* Noises decay when they are read, nothing to do per frame */
+	PrimaryActorTick.bCanEverTick = false;
+
+	DecaySeconds = 2.f;
+	NumReports = 0;
+	NumSamples = 0;
+}
+
+void ANoiseFieldManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const AGunslingersGameMode* const Settings = GetWorld()->GetGameState() ? GetWorld()->GetGameState()->GetDefaultGameMode<AGunslingersGameMode>() : nullptr;
+	if (Settings)
+	{
+		DecaySeconds = FMath::Max(Settings->NoiseDecaySeconds, KINDA_SMALL_NUMBER);
+	}
+}
+
+ANoiseFieldManager* ANoiseFieldManager::Get(const UObject* WorldContextObject)
+{
+	const UWorld* const World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	const AGunslingersGameState* const GS = World ? World->GetGameState<AGunslingersGameState>() : nullptr;
+
+	return GS ? GS->GetNoiseFieldManager() : nullptr;
+}
+
+void ANoiseFieldManager::ReportNoise(APawn* NoiseInstigator, const FVector& Location, float Loudness)
+{
+	const AGunslingersGameState* const GS = GetWorld()->GetGameState<AGunslingersGameState>();
+	if (GS == nullptr || Loudness <= 0.f)
+	{
+		return;
+	}
+
+	NumReports++;
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	const FIntPoint CellCoord = GS->LocationToCell(Location);
+	FNoiseFieldCell* const Cell = Cells.Find(CellCoord);
+
+	/* Quieter than what is left of the cell's last noise, listeners would not pick it anyway */
+	if (Cell && GetDecayedLoudness(*Cell, Now) > Loudness)
+	{
+		return;
+	}
+
+	FNoiseFieldCell& NewCell = Cell ? *Cell : Cells.Add(CellCoord);
+	NewCell.Location = Location;
+	NewCell.Loudness = Loudness;
+	NewCell.Time = Now;
+	NewCell.Instigator = NoiseInstigator;
+}
+
+bool ANoiseFieldManager::SampleNoise(const FVector& Location, float MinLoudness, FNoiseFieldCell& OutNoise) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_SampleNoiseField);
+
+	const AGunslingersGameState* const GS = GetWorld()->GetGameState<AGunslingersGameState>();
+	if (GS == nullptr)
+	{
+		return false;
+	}
+
+	NumSamples++;
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	const FIntPoint Center = GS->LocationToCell(Location);
+	float BestLoudness = MinLoudness;
+	bool bHeard = false;
+
+	for (int32 Y = -1; Y <= 1; Y++)
+	{
+		for (int32 X = -1; X <= 1; X++)
+		{
+			const FNoiseFieldCell* const Cell = Cells.Find(Center + FIntPoint(X, Y));
+			if (Cell == nullptr)
+			{
+				continue;
+			}
+
+			const float Loudness = GetDecayedLoudness(*Cell, Now);
+			if (Loudness >= BestLoudness)
+			{
+				BestLoudness = Loudness;
+				OutNoise = *Cell;
+				OutNoise.Loudness = Loudness;
+				bHeard = true;
+			}
+		}
+	}
+
+	return bHeard;
+}
+
+int32 ANoiseFieldManager::GetNumReports() const
+{
+	return NumReports;
+}
+
+int32 ANoiseFieldManager::GetNumSamples() const
+{
+	return NumSamples;
+}
+
+float ANoiseFieldManager::GetDecayedLoudness(const FNoiseFieldCell& Cell, float Now) const
+{
+	return Cell.Loudness * FMath::Max(0.f, 1.f - (Now - Cell.Time) / DecaySeconds);
+}
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "NoiseFieldManager.generated.h"
+
+/* Loudest noise of one grid cell, fading over the manager's decay time */
+struct FNoiseFieldCell
+{
+	FVector Location;
+	float Loudness;
+	float Time;
+	TWeakObjectPtr<APawn> Instigator;
+};
+
+/**
+* Server side noise field over the arena grid. Every noise made in a cell is folded into that cell,
+* which keeps only the loudest one as it decays, so a burst of automatic fire costs one write per
+* shot and nothing per listener. Listeners sample their own cell and the eight around it at their
+* own rate instead of being told about every noise.
+*/
+UCLASS()
+class GUNSLINGERS_API ANoiseFieldManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ANoiseFieldManager();
+
+	virtual void BeginPlay() override;
+
+	/* Noise field of the world WorldContextObject is in, null on clients or when noises are broadcast */
+	static ANoiseFieldManager* Get(const UObject* WorldContextObject);
+
+	/* Keep the noise in its cell if it is louder than what the cell still holds */
+	void ReportNoise(APawn* NoiseInstigator, const FVector& Location, float Loudness);
+
+	/* Loudest noise around Location that is still at least MinLoudness after decay */
+	bool SampleNoise(const FVector& Location, float MinLoudness, FNoiseFieldCell& OutNoise) const;
+
+	/* Noises reported and samples taken since the match started */
+	int32 GetNumReports() const;
+
+	int32 GetNumSamples() const;
+
+private:
+
+	/* Loudness left of Cell at Now */
+	float GetDecayedLoudness(const FNoiseFieldCell& Cell, float Now) const;
+
+	TMap<FIntPoint, FNoiseFieldCell> Cells;
+
+	/* Seconds a noise takes to fade out completely */
+	float DecaySeconds;
+
+	int32 NumReports;
+
+	mutable int32 NumSamples;
+};
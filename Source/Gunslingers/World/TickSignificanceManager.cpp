@@ -0,0 +1,289 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Gunslingers.h"
+#include "TickSignificanceManager.h"
+#include "GunslingersGameMode.h"
+#include "GunslingersGameState.h"
+#include "Tile.h"
+#include "Items/Weapons/Weapon.h"
+#include "Characters/PlayerCharacter.h"
+#include "AI/PatrolComponent.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "EngineUtils.h"
+
+DECLARE_STATS_GROUP(TEXT("TickSignificance"), STATGROUP_TickSignificance, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Score Significance"), STAT_ScoreSignificance, STATGROUP_TickSignificance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Registered Ticks"), STAT_RegisteredTicks, STATGROUP_TickSignificance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Ticks Skipped"), STAT_TicksSkipped, STATGROUP_TickSignificance);
+
+
+ATickSignificanceManager::ATickSignificanceManager()
+{
+	/* Scores before the ticks it controls are dispatched */
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	NextEntry = 0;
+	FMemory::Memzero(NumPerSignificance);
+	TicksSkippedLastFrame = 0;
+
+	UpdateBudgetSeconds = 0.00025;
+	NearDistanceSquared = FMath::Square(3000.f);
+	ReducedDistanceSquared = FMath::Square(8000.f);
+	LowDistanceSquared = FMath::Square(20000.f);
+	ReducedTickInterval = 0.1f;
+	LowTickInterval = 0.5f;
+}
+
+void ATickSignificanceManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const AGunslingersGameMode* const Settings = GetWorld()->GetGameState() ? GetWorld()->GetGameState()->GetDefaultGameMode<AGunslingersGameMode>() : nullptr;
+	if (Settings)
+	{
+		UpdateBudgetSeconds = FMath::Max(0.f, Settings->SignificanceBudgetMs) / 1000.0;
+		NearDistanceSquared = FMath::Square(Settings->FullTickDistance);
+		ReducedDistanceSquared = FMath::Square(Settings->ReducedTickDistance);
+		LowDistanceSquared = FMath::Square(Settings->LowTickDistance);
+		ReducedTickInterval = Settings->ReducedTickInterval;
+		LowTickInterval = Settings->LowTickInterval;
+	}
+
+	/* Actors spawned after this point register themselves from their BeginPlay */
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		AActor* const Actor = *It;
+		if (Actor == this || !Actor->HasActorBegunPlay())
+		{
+			continue;
+		}
+
+		if (Actor->IsA(ATile::StaticClass()) || Actor->IsA(AWeapon::StaticClass()))
+		{
+			RegisterActor(Actor, false, true);
+		}
+		else if (Actor->IsA(APlayerCharacter::StaticClass()))
+		{
+			RegisterActor(Actor, true, false);
+		}
+
+		TArray<UPatrolComponent*> PatrolComponents;
+		Actor->GetComponents(PatrolComponents);
+		for (UPatrolComponent* Patrol : PatrolComponents)
+		{
+			RegisterComponent(Patrol, false, true);
+		}
+	}
+}
+
+void ATickSignificanceManager::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ScoreSignificance);
+
+		GatherViewers();
+
+		/* Round robin, always at least one entry so a zero budget still makes progress */
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 NumScored = 0; NumScored < Entries.Num(); NumScored++)
+		{
+			if (NextEntry >= Entries.Num())
+			{
+				NextEntry = 0;
+			}
+
+			const FTickSignificanceEntry& Entry = Entries[NextEntry];
+			if (Entry.Actor.IsValid() && !Entry.Component.IsStale())
+			{
+				UpdateEntry(NextEntry++);
+			}
+			else
+			{
+				NumPerSignificance[(uint8)Entry.Significance]--;
+				Entries.RemoveAtSwap(NextEntry);
+			}
+
+			if (FPlatformTime::Seconds() - StartTime >= UpdateBudgetSeconds)
+			{
+				break;
+			}
+		}
+	}
+
+	/* A throttled tick runs about once every Interval seconds, so it skips the frames in between */
+	const float ReducedSkipped = ReducedTickInterval > 0.f ? FMath::Max(0.f, 1.f - DeltaSeconds / ReducedTickInterval) : 0.f;
+	const float LowSkipped = LowTickInterval > 0.f ? FMath::Max(0.f, 1.f - DeltaSeconds / LowTickInterval) : 0.f;
+
+	TicksSkippedLastFrame = NumPerSignificance[(uint8)ETickSignificance::Dormant] + NumPerSignificance[(uint8)ETickSignificance::Off]
+		+ FMath::RoundToInt(NumPerSignificance[(uint8)ETickSignificance::Reduced] * ReducedSkipped + NumPerSignificance[(uint8)ETickSignificance::Low] * LowSkipped);
+
+	SET_DWORD_STAT(STAT_RegisteredTicks, Entries.Num());
+	SET_DWORD_STAT(STAT_TicksSkipped, TicksSkippedLastFrame);
+}
+
+ATickSignificanceManager* ATickSignificanceManager::Get(const UObject* WorldContextObject)
+{
+	const UWorld* const World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	const AGunslingersGameState* const GS = World ? World->GetGameState<AGunslingersGameState>() : nullptr;
+
+	return GS ? GS->GetTickSignificanceManager() : nullptr;
+}
+
+void ATickSignificanceManager::RegisterActor(AActor* Actor, bool bHasNativeTick, bool bCanDisable)
+{
+	if (Actor && Actor->PrimaryActorTick.bCanEverTick)
+	{
+		FTickSignificanceEntry Entry;
+		Entry.Actor = Actor;
+		Entry.bCanDisable = bCanDisable;
+		Entry.Significance = ETickSignificance::Full;
+		NumPerSignificance[(uint8)Entry.Significance]++;
+
+		if (!bHasNativeTick && !HasBlueprintTick(Actor))
+		{
+			ApplySignificance(Entry, ETickSignificance::Dormant);
+		}
+
+		Entries.Add(Entry);
+	}
+}
+
+void ATickSignificanceManager::RegisterComponent(UActorComponent* Component, bool bHasNativeTick, bool bCanDisable)
+{
+	if (Component && Component->GetOwner() && Component->PrimaryComponentTick.bCanEverTick)
+	{
+		FTickSignificanceEntry Entry;
+		Entry.Actor = Component->GetOwner();
+		Entry.Component = Component;
+		Entry.bCanDisable = bCanDisable;
+		Entry.Significance = ETickSignificance::Full;
+		NumPerSignificance[(uint8)Entry.Significance]++;
+
+		if (!bHasNativeTick && !HasBlueprintTick(Component))
+		{
+			ApplySignificance(Entry, ETickSignificance::Dormant);
+		}
+
+		Entries.Add(Entry);
+	}
+}
+
+int32 ATickSignificanceManager::GetTicksSkippedLastFrame() const
+{
+	return TicksSkippedLastFrame;
+}
+
+int32 ATickSignificanceManager::GetNumRegistered() const
+{
+	return Entries.Num();
+}
+
+void ATickSignificanceManager::UpdateEntry(int32 Index)
+{
+	FTickSignificanceEntry& Entry = Entries[Index];
+
+	if (Entry.Significance == ETickSignificance::Dormant)
+	{
+		return;
+	}
+
+	const ETickSignificance NewSignificance = ScoreEntry(Entry);
+	if (NewSignificance != Entry.Significance)
+	{
+		ApplySignificance(Entry, NewSignificance);
+	}
+}
+
+void ATickSignificanceManager::ApplySignificance(FTickSignificanceEntry& Entry, ETickSignificance NewSignificance)
+{
+	NumPerSignificance[(uint8)Entry.Significance]--;
+	NumPerSignificance[(uint8)NewSignificance]++;
+	Entry.Significance = NewSignificance;
+
+	const bool bEnabled = NewSignificance != ETickSignificance::Dormant && NewSignificance != ETickSignificance::Off;
+	const float Interval = NewSignificance == ETickSignificance::Reduced ? ReducedTickInterval : NewSignificance == ETickSignificance::Low ? LowTickInterval : 0.f;
+
+	UActorComponent* const Component = Entry.Component.Get();
+	if (Component)
+	{
+		Component->SetComponentTickInterval(Interval);
+		Component->SetComponentTickEnabled(bEnabled);
+	}
+	else
+	{
+		AActor* const Actor = Entry.Actor.Get();
+		Actor->SetActorTickInterval(Interval);
+		Actor->SetActorTickEnabled(bEnabled);
+	}
+}
+
+ETickSignificance ATickSignificanceManager::ScoreEntry(const FTickSignificanceEntry& Entry) const
+{
+	const AActor* const Actor = Entry.Actor.Get();
+
+	/* Players always simulate their own pawn at full rate */
+	const APawn* const Pawn = Cast<APawn>(Actor);
+	if (Pawn && Pawn->IsLocallyControlled())
+	{
+		return ETickSignificance::Full;
+	}
+
+	ETickSignificance Significance = ETickSignificance::Off;
+
+	if (!Actor->bHidden)
+	{
+		float MinDistanceSquared = MAX_flt;
+		for (const FVector& Viewer : ViewerLocations)
+		{
+			MinDistanceSquared = FMath::Min(MinDistanceSquared, FVector::DistSquared(Viewer, Actor->GetActorLocation()));
+		}
+
+		/* Anything on a client's screen keeps ticking every frame */
+		if (MinDistanceSquared <= NearDistanceSquared || (GetNetMode() != NM_DedicatedServer && Actor->WasRecentlyRendered()))
+		{
+			Significance = ETickSignificance::Full;
+		}
+		else if (MinDistanceSquared <= ReducedDistanceSquared)
+		{
+			Significance = ETickSignificance::Reduced;
+		}
+		else if (MinDistanceSquared <= LowDistanceSquared)
+		{
+			Significance = ETickSignificance::Low;
+		}
+	}
+
+	if (Significance == ETickSignificance::Off && !Entry.bCanDisable)
+	{
+		Significance = ETickSignificance::Low;
+	}
+
+	return Significance;
+}
+
+void ATickSignificanceManager::GatherViewers()
+{
+	ViewerLocations.Reset();
+
+	/* The server sees every player controller, a client only its own */
+	for (TActorIterator<APlayerController> It(GetWorld()); It; ++It)
+	{
+		const AActor* const ViewTarget = It->GetViewTarget();
+		if (ViewTarget)
+		{
+			ViewerLocations.Add(ViewTarget->GetActorLocation());
+		}
+	}
+}
+
+bool ATickSignificanceManager::HasBlueprintTick(const UObject* Object)
+{
+	/* Event Tick is ReceiveTick on both actors and components */
+	const UFunction* const TickFunction = Object->GetClass()->FindFunctionByName(TEXT("ReceiveTick"));
+
+	/* Overriding Event Tick puts the function on the blueprint class */
+	return TickFunction && TickFunction->GetOuter() && TickFunction->GetOuter()->IsA(UBlueprintGeneratedClass::StaticClass());
+}
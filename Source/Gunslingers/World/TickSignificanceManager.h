@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "TickSignificanceManager.generated.h"
+
+/* How often a registered tick runs, from its distance to the nearest player */
+enum class ETickSignificance : uint8
+{
+	/* Nothing to run, the tick stays off */
+	Dormant,
+	/* Near or on screen, ticks every frame */
+	Full,
+	Reduced,
+	Low,
+	/* Far away or hidden, ticks only when it is allowed to be switched off entirely */
+	Off
+};
+
+/* An actor or component whose tick the manager controls */
+struct FTickSignificanceEntry
+{
+	TWeakObjectPtr<AActor> Actor;
+	/* Set when the tick belongs to a component of Actor */
+	TWeakObjectPtr<UActorComponent> Component;
+	/* False for ticks that do gameplay work and must keep running, just slower */
+	bool bCanDisable;
+	ETickSignificance Significance;
+};
+
+/**
+* Scores ticking actors and components by their distance to every player the machine knows about
+* (all players on the server, local players on clients) and throttles or switches off their ticks.
+* Scoring is spread over frames within a CPU budget.
+*/
+UCLASS()
+class GUNSLINGERS_API ATickSignificanceManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ATickSignificanceManager();
+
+	/* Picks up actors that began play before the manager existed */
+	virtual void BeginPlay() override;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	/* Manager of the world WorldContextObject is in, null when significance is not managed */
+	static ATickSignificanceManager* Get(const UObject* WorldContextObject);
+
+	/* Take over the actor tick. bHasNativeTick is false when the C++ tick is empty,
+	   such ticks are switched off unless a blueprint implements Event Tick. */
+	void RegisterActor(AActor* Actor, bool bHasNativeTick, bool bCanDisable);
+
+	void RegisterComponent(UActorComponent* Component, bool bHasNativeTick, bool bCanDisable);
+
+	/* Ticks the engine skipped last frame because of the manager, the throttled ones are estimated from their interval */
+	UFUNCTION(BlueprintCallable, Category = "Performance")
+	int32 GetTicksSkippedLastFrame() const;
+
+	int32 GetNumRegistered() const;
+
+private:
+
+	/* Score Entries[Index] and apply its new tick rate when it changed */
+	void UpdateEntry(int32 Index);
+
+	void ApplySignificance(FTickSignificanceEntry& Entry, ETickSignificance NewSignificance);
+
+	ETickSignificance ScoreEntry(const FTickSignificanceEntry& Entry) const;
+
+	/* Locations of every player view target, refreshed once per frame */
+	void GatherViewers();
+
+	static bool HasBlueprintTick(const UObject* Object);
+
+	TArray<FTickSignificanceEntry> Entries;
+
+	/* Entry the next frame's scoring starts at */
+	int32 NextEntry;
+
+	/* Entries per significance, indexed by ETickSignificance */
+	int32 NumPerSignificance[5];
+
+	TArray<FVector, TInlineAllocator<16>> ViewerLocations;
+
+	int32 TicksSkippedLastFrame;
+
+	double UpdateBudgetSeconds;
+
+	float NearDistanceSquared;
+
+	float ReducedDistanceSquared;
+
+	float LowDistanceSquared;
+
+	float ReducedTickInterval;
+
+	float LowTickInterval;
+};
@@ -2,6 +2,7 @@
 
 #include "Gunslingers.h"
 #include "Tile.h"
+#include "TickSignificanceManager.h"
 
 
 // Sets default values
@@ -12,11 +13,25 @@ ATile::ATile()
 
 }
 
+void ATile::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	// Never replicate, even if the blueprint asks for it
+	SetReplicates(false);
+}
+
 // Called when the game starts or when spawned
 void ATile::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	// The native tick is empty, only blueprint tiles with Event Tick keep ticking
+	ATickSignificanceManager* const SignificanceManager = ATickSignificanceManager::Get(this);
+	if (SignificanceManager)
+	{
+		SignificanceManager->RegisterActor(this, false, true);
+	}
 }
 
 // Called every frame
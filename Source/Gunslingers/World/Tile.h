@@ -14,6 +14,9 @@ public:
 	// Sets default values for this actor's properties
 	ATile();
 
+	// Tiles are generated locally on every machine from the replicated layout seed
+	virtual void PostInitializeComponents() override;
+
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 	
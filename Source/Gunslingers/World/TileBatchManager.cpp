@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Gunslingers.h"
+#include "TileBatchManager.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+
+
+ATileBatchManager::ATileBatchManager()
+{
+	// Instances never move once placed
+	PrimaryActorTick.bCanEverTick = false;
+
+	SceneRoot = CreateDefaultSubobject<USceneComponent>(TEXT("SceneRoot"));
+	SceneRoot->SetMobility(EComponentMobility::Static);
+	RootComponent = SceneRoot;
+}
+
+void ATileBatchManager::AddTileInstance(UClass* TileType, UStaticMesh* Mesh, const FTransform& InstanceTransform, int32 ChunkIndex)
+{
+	UHierarchicalInstancedStaticMeshComponent* Batch = FindOrAddBatch(TileType, Mesh, ChunkIndex);
+	if (Batch)
+	{
+		Batch->AddInstanceWorldSpace(InstanceTransform);
+	}
+}
+
+void ATileBatchManager::ClearTileInstances()
+{
+	for (UHierarchicalInstancedStaticMeshComponent* Batch : Batches)
+	{
+		Batch->ClearInstances();
+
+		/* A chunk hidden by streaming may be refilled by the next layout */
+		Batch->SetVisibility(true);
+		Batch->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+	}
+}
+
+void ATileBatchManager::SetChunkVisible(int32 ChunkIndex, bool bVisible)
+{
+	for (int32 i = 0; i < Batches.Num(); i++)
+	{
+		if (BatchChunks[i] == ChunkIndex)
+		{
+			Batches[i]->SetVisibility(bVisible);
+			Batches[i]->SetCollisionEnabled(bVisible ? ECollisionEnabled::QueryAndPhysics : ECollisionEnabled::NoCollision);
+		}
+	}
+}
+
+int32 ATileBatchManager::GetNumBatches() const
+{
+	return Batches.Num();
+}
+
+int32 ATileBatchManager::GetNumInstances() const
+{
+	int32 NumInstances = 0;
+	for (const UHierarchicalInstancedStaticMeshComponent* Batch : Batches)
+	{
+		NumInstances += Batch->GetInstanceCount();
+	}
+
+	return NumInstances;
+}
+
+UHierarchicalInstancedStaticMeshComponent* ATileBatchManager::FindOrAddBatch(UClass* TileType, UStaticMesh* Mesh, int32 ChunkIndex)
+{
+	const FIntPoint Key(TileTypes.AddUnique(TileType), ChunkIndex);
+
+	const int32* BatchIndex = BatchIndices.Find(Key);
+	if (BatchIndex)
+	{
+		return Batches[*BatchIndex];
+	}
+
+	if (Mesh == nullptr)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("No batch mesh for tile type %s."), *GetNameSafe(TileType));
+		return nullptr;
+	}
+
+	UHierarchicalInstancedStaticMeshComponent* Batch = NewObject<UHierarchicalInstancedStaticMeshComponent>(this);
+	Batch->SetMobility(EComponentMobility::Static);
+	Batch->SetStaticMesh(Mesh);
+	Batch->SetupAttachment(SceneRoot);
+	Batch->RegisterComponent();
+
+	BatchIndices.Add(Key, Batches.Add(Batch));
+	BatchChunks.Add(ChunkIndex);
+
+	return Batch;
+}
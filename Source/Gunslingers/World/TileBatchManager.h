@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "TileBatchManager.generated.h"
+
+/**
+* Renders every cell of a tile type through one hierarchical instanced static mesh component,
+* so the arena costs one actor and one component per tile type instead of one actor per cell.
+*/
+UCLASS()
+class GUNSLINGERS_API ATileBatchManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ATileBatchManager();
+
+	/* Add one cell of TileType, the transform keeps the tile's rotation. Cells of different
+	   streaming chunks go to separate components so each chunk can be hidden on its own. */
+	void AddTileInstance(UClass* TileType, UStaticMesh* Mesh, const FTransform& InstanceTransform, int32 ChunkIndex = 0);
+
+	/* Show or hide every batch of a streaming chunk, with its collision */
+	void SetChunkVisible(int32 ChunkIndex, bool bVisible);
+
+	/* Drop every instance but keep the components for the next layout */
+	void ClearTileInstances();
+
+	int32 GetNumBatches() const;
+
+	int32 GetNumInstances() const;
+
+private:
+
+	UPROPERTY(VisibleAnywhere, Category = "Tiles")
+	USceneComponent* SceneRoot;
+
+	/* One component per tile type and chunk */
+	UPROPERTY(Transient)
+	TArray<class UHierarchicalInstancedStaticMeshComponent*> Batches;
+
+	/* Chunk of each entry in Batches */
+	TArray<int32> BatchChunks;
+
+	TArray<UClass*> TileTypes;
+
+	/* (index in TileTypes, chunk) to index in Batches */
+	TMap<FIntPoint, int32> BatchIndices;
+
+	class UHierarchicalInstancedStaticMeshComponent* FindOrAddBatch(UClass* TileType, UStaticMesh* Mesh, int32 ChunkIndex);
+};
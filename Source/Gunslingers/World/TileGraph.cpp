@@ -0,0 +1,176 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Gunslingers.h"
+#include "TileGraph.h"
+
+
+FTileGraph::FTileGraph()
+	: UseCounter(0),
+	NumSearches(0),
+	NumLookups(0)
+{
+}
+
+void FTileGraph::Build(const FLevelLayout& Layout)
+{
+	Reset();
+
+	Cells = Layout.TileCells;
+	NodeIndices.Reserve(Cells.Num());
+	for (int32 Node = 0; Node < Cells.Num(); Node++) {
+		NodeIndices.Add(Cells[Node], Node);
+	}
+
+	Neighbors.SetNumUninitialized(Cells.Num() * 4);
+	for (int32 Node = 0; Node < Cells.Num(); Node++) {
+		for (int32 i = 0; i < 4; i++) {
+			Neighbors[Node * 4 + i] = FindNode(Cells[Node] + FLevelLayout::NeighborOffsets[i]);
+		}
+	}
+}
+
+void FTileGraph::Reset()
+{
+	Cells.Reset();
+	NodeIndices.Reset();
+	Neighbors.Reset();
+	HopFields.Reset();
+	HopFieldIndices.Reset();
+	UseCounter = 0;
+	NumSearches = 0;
+	NumLookups = 0;
+}
+
+int32 FTileGraph::FindNode(const FIntPoint& Cell) const
+{
+	const int32* Node = NodeIndices.Find(Cell);
+	return Node ? *Node : INDEX_NONE;
+}
+
+int32 FTileGraph::GetNumNodes() const
+{
+	return Cells.Num();
+}
+
+const FIntPoint& FTileGraph::GetCell(int32 Node) const
+{
+	return Cells[Node];
+}
+
+int32 FTileGraph::GetNextHop(int32 Node, int32 Destination) const
+{
+	if (!Cells.IsValidIndex(Node) || !Cells.IsValidIndex(Destination))
+	{
+		return INDEX_NONE;
+	}
+
+	const int32* FieldIndex = HopFieldIndices.Find(Destination);
+	if (FieldIndex)
+	{
+		NumLookups++;
+	}
+	else
+	{
+		/* Reuse the least recently used field once the cache is full */
+		int32 NewIndex = HopFields.Num();
+		if (HopFields.Num() >= MaxCachedDestinations)
+		{
+			NewIndex = 0;
+			for (int32 i = 1; i < HopFields.Num(); i++)
+			{
+				if (HopFields[i].LastUsed < HopFields[NewIndex].LastUsed) { NewIndex = i; }
+			}
+			HopFieldIndices.Remove(HopFields[NewIndex].Destination);
+		}
+		else
+		{
+			HopFields.AddDefaulted();
+		}
+
+		HopFields[NewIndex].Destination = Destination;
+		BuildHopField(Destination, HopFields[NewIndex].NextHop);
+		FieldIndex = &HopFieldIndices.Add(Destination, NewIndex);
+		NumSearches++;
+	}
+
+	FHopField& Field = HopFields[*FieldIndex];
+	Field.LastUsed = ++UseCounter;
+
+	return Field.NextHop[Node];
+}
+
+bool FTileGraph::FindRouteUncached(int32 From, int32 To, TArray<int32>& OutRoute) const
+{
+	OutRoute.Reset();
+
+	if (!Cells.IsValidIndex(From) || !Cells.IsValidIndex(To))
+	{
+		return false;
+	}
+
+	TArray<int32> Parents;
+	Parents.Init(INDEX_NONE, Cells.Num());
+	Parents[From] = From;
+
+	TArray<int32> Frontier;
+	Frontier.Reserve(Cells.Num());
+	Frontier.Add(From);
+
+	for (int32 Head = 0; Head < Frontier.Num() && Parents[To] == INDEX_NONE; Head++) {
+		const int32 Node = Frontier[Head];
+		for (int32 i = 0; i < 4; i++) {
+			const int32 Neighbor = Neighbors[Node * 4 + i];
+			if (Neighbor != INDEX_NONE && Parents[Neighbor] == INDEX_NONE) {
+				Parents[Neighbor] = Node;
+				Frontier.Add(Neighbor);
+			}
+		}
+	}
+
+	if (Parents[To] == INDEX_NONE)
+	{
+		return false;
+	}
+
+	for (int32 Node = To; Node != From; Node = Parents[Node]) {
+		OutRoute.Add(Node);
+	}
+	OutRoute.Add(From);
+
+	for (int32 i = 0, j = OutRoute.Num() - 1; i < j; i++, j--) {
+		OutRoute.Swap(i, j);
+	}
+	return true;
+}
+
+int32 FTileGraph::GetNumSearches() const
+{
+	return NumSearches;
+}
+
+int32 FTileGraph::GetNumLookups() const
+{
+	return NumLookups;
+}
+
+void FTileGraph::BuildHopField(int32 Destination, TArray<int32>& OutNextHop) const
+{
+	/* Searching outward from the destination, each node's parent is its next hop toward it */
+	OutNextHop.Init(INDEX_NONE, Cells.Num());
+	OutNextHop[Destination] = Destination;
+
+	TArray<int32> Frontier;
+	Frontier.Reserve(Cells.Num());
+	Frontier.Add(Destination);
+
+	for (int32 Head = 0; Head < Frontier.Num(); Head++) {
+		const int32 Node = Frontier[Head];
+		for (int32 i = 0; i < 4; i++) {
+			const int32 Neighbor = Neighbors[Node * 4 + i];
+			if (Neighbor != INDEX_NONE && OutNextHop[Neighbor] == INDEX_NONE) {
+				OutNextHop[Neighbor] = Node;
+				Frontier.Add(Neighbor);
+			}
+		}
+	}
+}
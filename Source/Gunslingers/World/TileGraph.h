@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "LevelLayoutGenerator.h"
+
+/**
+* Coarse navigation graph of the arena: one node per tile cell, edges between edge neighbours that
+* both hold a tile. Guards route over it tile by tile and only use the navmesh to reach the next tile.
+*
+* Routes are cached per destination as a next hop field (one breadth first search from the
+* destination answers every start tile), shared by every guard heading to the same tile.
+*/
+class GUNSLINGERS_API FTileGraph
+{
+public:
+	FTileGraph();
+
+	void Build(const FLevelLayout& Layout);
+
+	void Reset();
+
+	/* Node of a tile cell, INDEX_NONE when the cell holds no tile */
+	int32 FindNode(const FIntPoint& Cell) const;
+
+	int32 GetNumNodes() const;
+
+	const FIntPoint& GetCell(int32 Node) const;
+
+	/* Neighbour of Node one step closer to Destination, Node itself once there, INDEX_NONE when unreachable */
+	int32 GetNextHop(int32 Node, int32 Destination) const;
+
+	/* Fresh breadth first search from From to To, bypassing the cache. Route includes both ends. */
+	bool FindRouteUncached(int32 From, int32 To, TArray<int32>& OutRoute) const;
+
+	/* Searches run to fill the cache, every other GetNextHop was a lookup */
+	int32 GetNumSearches() const;
+
+	int32 GetNumLookups() const;
+
+	/* Destinations kept at once, the least recently used one is replaced */
+	static const int32 MaxCachedDestinations = 64;
+
+private:
+
+	/* For every node, the next node toward Destination */
+	struct FHopField
+	{
+		int32 Destination;
+		TArray<int32> NextHop;
+		uint32 LastUsed;
+	};
+
+	void BuildHopField(int32 Destination, TArray<int32>& OutNextHop) const;
+
+	TArray<FIntPoint> Cells;
+
+	TMap<FIntPoint, int32> NodeIndices;
+
+	/* Four entries per node in FLevelLayout::NeighborOffsets order, INDEX_NONE where there is no tile */
+	TArray<int32> Neighbors;
+
+	/* The route cache, filled lazily from const queries */
+	mutable TArray<FHopField> HopFields;
+
+	mutable TMap<int32, int32> HopFieldIndices;
+
+	mutable uint32 UseCounter;
+
+	mutable int32 NumSearches;
+
+	mutable int32 NumLookups;
+};